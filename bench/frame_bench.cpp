@@ -0,0 +1,271 @@
+// frame_bench.cpp
+// End-to-end frame scenarios on SDL's software renderer and dummy video driver, so it runs without a GPU.
+// Times zbj::draw for setup, then zmain::clearRender + zbj::show + zmain::present per frame.
+// Usage: bench_frame [items]
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include "zbj.h"
+#include "zfont.h"
+#include "zmain.h"
+
+// Every C++ heap allocation in the process goes through here, SDL's (and SDL_ttf's) through the
+// SDL_SetMemoryFunctions hooks below; SDL may allocate on its own threads
+static std::atomic<size_t> allocs{ 0 };
+
+void* operator new(size_t size) {
+	allocs++;
+	if (void* p = std::malloc(size ? size : 1)) return p;
+	throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+static void* SDLCALL countedMalloc(size_t size) { allocs++; return std::malloc(size); }
+static void* SDLCALL countedCalloc(size_t n, size_t size) { allocs++; return std::calloc(n, size); }
+static void* SDLCALL countedRealloc(void* p, size_t size) { allocs++; return std::realloc(p, size); }
+static void SDLCALL countedFree(void* p) { std::free(p); }
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsedNS(Clock::time_point since) {
+	return std::chrono::duration<double, std::nano>(Clock::now() - since).count();
+}
+
+struct FrameResult {
+	double fps;
+	double frameNS;
+	double allocsPerFrame;
+};
+
+// Runs frames until ~1s has passed (at least 20), after a short warm-up
+static FrameResult frames(zmain& app, const std::function<void(int)>& body) {
+	auto frame = [&](int i) {
+		app.clearRender({ 0x11, 0x11, 0x11, 255 });
+		body(i);
+		app.present();
+	};
+	for (int i = 0; i < 10; i++) frame(i);
+	size_t a0 = allocs;
+	auto start = Clock::now();
+	int n = 0;
+	while (n < 20 || (elapsedNS(start) < 1e9 && n < 5000)) frame(n++);
+	double ns = elapsedNS(start);
+	return { n * 1e9 / ns, ns / n, static_cast<double>(allocs - a0) / n };
+}
+
+static void report(const char* name, size_t items, double drawNS, size_t drawAllocs, const FrameResult& f) {
+	std::printf("%-16s %7zu %12.0f %10zu %9.1f %12.1f %12.1f\n",
+		name, items, drawNS / items, drawAllocs, f.fps, f.frameNS / items, f.allocsPerFrame);
+}
+
+static Point gridPos(size_t i, int w, int h, int winW) {
+	int cols = winW / w;
+	return { static_cast<int>(i % cols) * w, static_cast<int>(i / cols) * h % 900 };
+}
+
+static void benchRects(zmain& app, const char* name, size_t n, float radiusScale, bool lazy = false) {
+	zbj obj({ 0, 0, 40, 30 }, { 0x3c, 0x3c, 0x3c, 255 }, app.getRenderer());
+	obj.setLazy(lazy);
+	size_t a0 = allocs;
+	auto start = Clock::now();
+	for (size_t i = 0; i < n; i++) {
+		if (i > 0) obj.addItem();
+		Point p = gridPos(i, 44, 34, 1200);
+		obj.setBound({ p.x, p.y, 40, 30 });
+		obj.draw(radiusScale);
+	}
+	double drawNS = elapsedNS(start);
+	report(name, n, drawNS, allocs - a0, frames(app, [&](int) { obj.show(); }));
+}
+
+static void benchText(zmain& app, const char* name, Font font, size_t n, bool glyphs) {
+	zbj obj({ 0, 0, 0, 0 }, { 0xf1, 0xf1, 0xf1, 255 }, app.getRenderer());
+	size_t a0 = allocs;
+	auto start = Clock::now();
+	for (size_t i = 0; i < n; i++) {
+		if (i > 0) obj.addItem();
+		std::string label = "Label " + std::to_string(i);
+		if (glyphs) obj.drawText(font, label.c_str(), gridPos(i, 100, 24, 1200));
+		else obj.draw(font, label.c_str(), gridPos(i, 100, 24, 1200));
+	}
+	double drawNS = elapsedNS(start);
+	report(name, n, drawNS, allocs - a0, frames(app, [&](int) { obj.show(); }));
+}
+
+static void benchSprites(zmain& app, const char* sprite, size_t n) {
+	zbj obj(app.getRenderer());
+	obj.setPacked(true);
+	size_t a0 = allocs;
+	auto start = Clock::now();
+	for (size_t i = 0; i < n; i++) {
+		if (i > 0) obj.addItem();
+		obj.draw(sprite);
+		Point p = gridPos(i, 34, 34, 1200);
+		obj.setBound({ p.x, p.y, 32, 32 });
+	}
+	double drawNS = elapsedNS(start);
+	report("image sprites", n, drawNS, allocs - a0, frames(app, [&](int) { obj.show(); }));
+}
+
+// Demo1: full-window background, player, a row of scrolling land tiles and a score label redrawn on change
+static void benchScroller(zmain& app, Font font, const char* sprite) {
+	const int tile = 32;
+	Renderer r = app.getRenderer();
+	size_t a0 = allocs;
+	auto start = Clock::now();
+	zbj bg({ 0, 0, 1200, 900 }, { 0, 0, 0, 255 }, r);
+	bg.draw();
+	zbj player({ 300, 900 - 80, tile, tile }, { 240, 0, 240, 255 }, r);
+	player.draw();
+	zbj land({ 0, 900 - tile, tile, tile }, { 0, 240, 0, 255 }, r);
+	land.setPacked(true);
+	int tiles = 1200 / tile + 2;
+	for (int i = 0; i < tiles; i++) {
+		if (i > 0) land.addItem();
+		land.draw(sprite);
+		land.setBound({ tile * i, 900 - tile, tile, tile });
+	}
+	zbj score({ 550, 50, 100, 100 }, { 240, 0, 240, 255 }, r);
+	score.draw(font, "0", { 550, 50 });
+	double drawNS = elapsedNS(start);
+
+	size_t items = 3 + tiles;
+	report("demo1 scroller", items, drawNS, allocs - a0, frames(app, [&](int f) {
+		for (int i = 0; i < tiles; i++) {
+			land.setActiveID(i);
+			int x = (tile * i - f * 4) % (tile * tiles);
+			if (x < -tile) x += tile * tiles;
+			land.setBound({ x, 900 - tile, tile, tile });
+		}
+		if (f % 30 == 0) {
+			score.clearItems();
+			score.addItem();
+			score.draw(font, std::to_string(f / 30).c_str(), { 550, 50 });
+		}
+		bg.show();
+		player.show();
+		land.show();
+		score.show();
+	}));
+}
+
+// Scrolling spawner: every frame the oldest tile leaves and a new one enters, with n tiles alive
+static void benchSpawner(zmain& app, size_t n) {
+	zbj strip({ 0, 0, 8, 8 }, { 0x3c, 0x3c, 0x3c, 255 }, app.getRenderer());
+	std::deque<ItemHandle> live;
+	size_t a0 = allocs;
+	auto start = Clock::now();
+	strip.reserve(n + 1);
+	strip.fill();
+	live.push_back(strip.getHandle(0));
+	for (size_t i = 1; i < n; i++) {
+		live.push_back(strip.addItem());
+		strip.setBound({ static_cast<int>(i % 150) * 8, static_cast<int>(i / 150) * 8 % 900, 8, 8 });
+		strip.fill();
+	}
+	double drawNS = elapsedNS(start);
+	report("spawner churn", n, drawNS, allocs - a0, frames(app, [&](int f) {
+		strip.removeItem(live.front());
+		live.pop_front();
+		live.push_back(strip.addItem());
+		strip.setBound({ (f * 8) % 1200, (f / 150) * 8 % 900, 8, 8 });
+		strip.fill();
+		strip.show();
+	}));
+}
+
+// Demo2: large rounded layout, four cached nav buttons with an icon, one hover highlight per frame
+static void benchNav(zmain& app, const char* sprite) {
+	Renderer r = app.getRenderer();
+	size_t a0 = allocs;
+	auto start = Clock::now();
+	zbj layout(r);
+	layout.setAnchorPt(AnchorType::ANCHOR_BOT_RIGHT);
+	layout.setBound({ 1216, 916, 1128, 908 });
+	layout.setColor({ 0x1e, 0x1e, 0x1e, 255 });
+	layout.draw(0.05f);
+	std::vector<std::unique_ptr<zbj>> nav;
+	for (int id = 0; id < 4; id++) {
+		auto b = std::make_unique<zbj>(r);
+		b->setPacked(true);
+		b->setCached(true);
+		b->setColor({ 0x3c, 0x3c, 0x3c, 255 });
+		b->setBound({ 43, 86 * (id + 1), 86, 86 });
+		b->draw(0.25f);
+		b->setAnchorPt(AnchorType::ANCHOR_CENTER);
+		b->addItem();
+		b->draw(sprite);
+		b->setBound({ 43, 86 * (id + 1), 48, 48 });
+		nav.push_back(std::move(b));
+	}
+	zbj active(r);
+	active.setBound({ 0, 86, 24, 86 });
+	active.setColor({ 0x65, 0xe1, 0x0f, 255 });
+	active.draw(1.0f);
+	active.setAnchorPt(AnchorType::ANCHOR_CENTER);
+	double drawNS = elapsedNS(start);
+
+	report("demo2 nav", 6, drawNS, allocs - a0, frames(app, [&](int f) {
+		layout.show();
+		for (int id = 0; id < 4; id++) {
+			if (id == (f / 10) % 4) nav[id]->show(1);
+			else nav[id]->show();
+		}
+		active.show();
+	}));
+}
+
+// Solid 32x32 sprite written next to the binary, loaded through IMG_Load like any asset
+static bool writeSprite(const char* path) {
+	Surface s = SDL_CreateSurface(32, 32, SDL_PIXELFORMAT_RGBA32);
+	if (!s) return false;
+	SDL_FillSurfaceRect(s, nullptr, SDL_MapSurfaceRGBA(s, 0x65, 0xe1, 0x0f, 255));
+	bool ok = SDL_SaveBMP(s, path);
+	SDL_DestroySurface(s);
+	return ok;
+}
+
+int main(int argc, char** argv) {
+	// Before any other SDL call, memory SDL allocated with its default functions can not be freed by these
+	if (!SDL_SetMemoryFunctions(countedMalloc, countedCalloc, countedRealloc, countedFree)) {
+		std::fprintf(stderr, "Error: Could not hook SDL allocations: %s\n", SDL_GetError());
+		return 1;
+	}
+	size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+	// Environment variables still win, e.g. SDL_RENDER_DRIVER=opengl to compare against a GPU
+	SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "dummy");
+	SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+
+	zmain app({ "bench", 1200, 900, 0 });
+	if (!app.getRenderer()) return 1;
+	zfont fonts;
+	if (!fonts.loadFont("NotoSans", 16, "res/fonts/NotoSans-Regular.ttf")) return 1;
+	Font font = fonts.getFont("NotoSans", 16);
+	const char* sprite = "bin/bench_sprite.bmp";
+	if (!writeSprite(sprite)) { std::fprintf(stderr, "Error: Could not write %s: %s\n", sprite, SDL_GetError()); return 1; }
+
+	std::printf("renderer: %s\n", SDL_GetRendererName(app.getRenderer()));
+	std::printf("%-16s %7s %12s %10s %9s %12s %12s\n", "scenario", "items", "draw ns/item", "draw alloc", "fps", "frame ns/item", "alloc/frame");
+	benchRects(app, "solid rects", n, 0.0f);
+	benchRects(app, "rounded rects", n, 0.25f);
+	benchRects(app, "lazy rounded", n, 0.25f, true);
+	benchText(app, "text labels", font, n, false);
+	benchText(app, "glyph labels", font, n, true);
+	benchSprites(app, sprite, n);
+	benchSpawner(app, n);
+	benchScroller(app, font, sprite);
+	benchNav(app, sprite);
+
+	std::remove(sprite);
+	return 0;
+}
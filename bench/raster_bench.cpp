@@ -0,0 +1,61 @@
+// raster_bench.cpp
+// Compares zraster::roundRect against the angle/radius sweep zbj::draw(radiusScale) used before.
+#define _USE_MATH_DEFINES
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "zraster.h"
+
+// Previous implementation: same fills and corner sweep, writing into a plain buffer
+static void legacyRoundRect(Uint32* pixels, int w, int h, float radius, Uint32 pixel) {
+	for (int i = 0; i < w * h; i++) pixels[i] = 0;
+	int ir = static_cast<int>(radius);
+	for (int y = 0; y < h; y++) {
+		for (int x = 0; x < w; x++) {
+			bool inner1 = x >= ir && x < w - static_cast<int>(2 * radius) + ir;
+			bool inner2 = y >= ir && y < h - static_cast<int>(2 * radius) + ir;
+			if (inner1 || inner2) pixels[y * w + x] = pixel;
+		}
+	}
+	auto drawCorner = [&](SDL_FPoint center, float startAngle) {
+		for (float angle = 0; angle <= 90.0f; angle += 0.5f) {
+			float rad = (startAngle + angle) * (M_PI / 180.0f);
+			for (float r = 0; r <= radius; r += 0.5f) {
+				int x = static_cast<int>(center.x + r * cosf(rad));
+				int y = static_cast<int>(center.y + r * sinf(rad));
+				if (x >= 0 && y >= 0 && x < w && y < h) {
+					pixels[y * w + x] = pixel;
+				}
+			}
+		}
+	};
+	drawCorner({ radius, radius }, 180.0f);
+	drawCorner({ static_cast<float>(w) - radius, radius }, 270.0f);
+	drawCorner({ static_cast<float>(w) - radius, static_cast<float>(h) - radius }, 0.0f);
+	drawCorner({ radius, static_cast<float>(h) - radius }, 90.0f);
+}
+
+template <typename F>
+static double timeUs(int runs, F&& f) {
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < runs; i++) f();
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::micro>(end - start).count() / runs;
+}
+
+int main() {
+	Color color = { 0x3c, 0x3c, 0x3c, 255 };
+	Uint32 pixel = zraster::pixel(color, color.a);
+	std::printf("%8s %10s %14s %14s %9s\n", "radius", "size", "legacy (us)", "scanline (us)", "speedup");
+	for (int radius = 4; radius <= 512; radius *= 2) {
+		int w = 2 * radius + 16, h = 2 * radius + 16;
+		std::vector<Uint32> buffer(static_cast<size_t>(w) * h);
+		int runs = std::max(3, 4096 / radius);
+		double legacy = timeUs(runs, [&]() { legacyRoundRect(buffer.data(), w, h, static_cast<float>(radius), pixel); });
+		double scan = timeUs(runs, [&]() { zraster::roundRect(buffer.data(), w * 4, w, h, static_cast<float>(radius), color); });
+		std::printf("%8d %5dx%-4d %14.1f %14.1f %8.1fx\n", radius, w, h, legacy, scan, legacy / scan);
+	}
+	return 0;
+}
@@ -1,6 +1,7 @@
 #include <zketch.h>
 #include <ctime>
 #include <cstdlib>
+#include <deque>
 #include <string>
 #include <vector>
 using namespace std;
@@ -17,10 +18,11 @@ int initScore = 0;
 Event e;
 
 void updateScore(int val);
-void resetState(zbj &p, zbj &land, Bound &newBound, bool &isJump, bool &isFalling, int &jumpId, int &initScore, bool &gameOver, int tile);
+void resetState(zbj &p, zbj &land, deque<ItemHandle> &tiles, Bound &newBound, bool &isJump, bool &isFalling, int &jumpId, int &initScore, bool &gameOver, int tile);
 
 int main() {
 	srand(time(0));
+	app.setTargetFPS(60); // game steps are per frame, keep a steady 60
 	bool gameOver = false;
 	fonts.loadFont("NotoSans", 48, "res/fonts/NotoSans-Regular.ttf");
 	updateScore(initScore);
@@ -51,14 +53,17 @@ int main() {
 	bool isJump = false;
 	bool isFalling = false;
 
-	// land
+	// land, tiles in scroll order; removing the first one leaves every other handle valid
 	int gap = 60;
 	int n = app.getWinSize().w / tile;
 	zbj land({0, app.getWinSize().h - tile, tile, tile}, {0, 240, 0, 255}, app.getRenderer());
+	deque<ItemHandle> tiles;
+	land.setPacked(true);
+	land.reserve(2 * n);
 	land.draw("res/assets/land1.png");
+	tiles.push_back(land.getHandle(0));
 	for(int i = 1; i < n; i++){
-		land.addItem();
-		land.setActiveID(i);
+		tiles.push_back(land.addItem());
 		land.setBound({tile * i, app.getWinSize().h - tile, tile, tile});
 		if(i == n - 1){
 			land.draw("res/assets/land3.png");
@@ -68,6 +73,7 @@ int main() {
 	}
 
 	while(isRun){
+		app.pump();
 		app.clearRender({0, 0, 0, 255});
 		while(SDL_PollEvent(&e)){
 			if(e.type == SDL_EVENT_QUIT){
@@ -78,7 +84,7 @@ int main() {
 					isJump = true;
 				}
 				if (gameOver && e.key.key == SDLK_R) {
-					resetState(p, land, newBound, isJump, isFalling, jumpId, initScore, gameOver, tile);
+					resetState(p, land, tiles, newBound, isJump, isFalling, jumpId, initScore, gameOver, tile);
 				}
 			}
 		}
@@ -86,7 +92,6 @@ int main() {
 		if(gameOver){
 			scoreMsg.clearItems();
 			scoreMsg.addItem();
-			scoreMsg.setActiveID(scoreMsg.getTextures().size()-1);
 			scoreMsg.draw(fonts.getFont("NotoSans", 48), "Game Over", {360, 360});
 			Bound msg = scoreMsg.getBound();
 			msg.x -= msg.w/2;
@@ -94,7 +99,7 @@ int main() {
 			scoreMsg.setBound(msg);
 			scoreMsg.show();
 			app.present();
-			app.delay(1000/60);
+			app.pace();
 			continue;
 		}
 
@@ -109,9 +114,9 @@ int main() {
 		}
 
 		bool onLand = false;
-		for(size_t i = 0; i < land.getBounds().size(); i++){
-			land.setActiveID(i);
-			Bound lb = land.getBound();
+		for(ItemHandle t : tiles){
+			land.setActive(t);
+			Bound lb = land.getBounds()[t.index].origin;
 			lb.x -= 5;
 			land.setBound(lb);
 
@@ -138,20 +143,19 @@ int main() {
 			}
 		}
 
-		if (!land.getBounds().empty() && land.getBounds().front().x + land.getBounds().front().w < 0){
-			land.setActiveID(0);
-			land.removeItem(0);
+		if (!tiles.empty() && land.getBounds()[tiles.front().index].origin.x + tile < 0){
+			land.removeItem(tiles.front());
+			tiles.pop_front();
 			initScore++;
 			updateScore(initScore);
 		}
 
-		if(land.getBounds().empty() || land.getBounds().back().x + land.getBounds().back().w + gap < app.getWinSize().w){
+		if(tiles.empty() || land.getBounds()[tiles.back().index].origin.x + tile + gap < app.getWinSize().w){
 			int minTileCount = 3;
 			int maxTileCount = app.getWinSize().w / tile / 2;
 			n = minTileCount + rand() % (maxTileCount - minTileCount + 1);
 			for(int i = 1; i <= n; i++){
-				land.addItem();
-				land.setActiveID(land.getTextures().size()-1);
+				tiles.push_back(land.addItem());
 				land.setBound({app.getWinSize().w + tile * i, app.getWinSize().h - tile, tile, tile});
 				if(i == 1){
 					land.draw("res/assets/land1.png");
@@ -169,27 +173,28 @@ int main() {
 		}
 		scoreMsg.show();
 		p.show();
-		for(size_t i = 0; i < land.getBounds().size(); i++){
-			land.setActiveID(i);
-			land.show();
-		}
+		land.show();
 		app.present();
-		app.delay(1000/60);
+		app.pace();
 	}
 
 	return 0;
 }
 
 void updateScore(int val){
-	if(initScore >= 0){
-		scoreMsg.clearItems();
-		scoreMsg.addItem();
+	// the score label keeps its text item, a new value only re-shapes the string
+	if(scoreMsg.getCount() > 0 && scoreMsg.getItems()[0].text){
 		scoreMsg.setActiveID(0);
+		scoreMsg.setText(to_string(val).c_str());
+		return;
 	}
-	scoreMsg.draw(fonts.getFont("NotoSans", 48), to_string(val).c_str(), {30, 30});
+	scoreMsg.clearItems();
+	scoreMsg.addItem();
+	scoreMsg.setActiveID(0);
+	scoreMsg.drawText(fonts.getFont("NotoSans", 48), to_string(val).c_str(), {30, 30});
 }
 
-void resetState(zbj &p, zbj &land, Bound &newBound, bool &isJump, bool &isFalling, int &jumpId, int &initScore, bool &gameOver, int tile) {
+void resetState(zbj &p, zbj &land, deque<ItemHandle> &tiles, Bound &newBound, bool &isJump, bool &isFalling, int &jumpId, int &initScore, bool &gameOver, int tile) {
 	newBound = {app.getWinSize().w / 4, app.getWinSize().h - 80, tile, tile};
 	p.setBound(newBound);
 
@@ -198,14 +203,13 @@ void resetState(zbj &p, zbj &land, Bound &newBound, bool &isJump, bool &isFallin
 	jumpId = 0;
 
 	land.clearItems();
-	land.addItem();
-	land.setActiveID(0);
+	tiles.clear();
+	tiles.push_back(land.addItem());
 	land.setBound({0, app.getWinSize().h - tile, tile, tile});
 	land.draw("res/assets/land1.png");
 	int n = app.getWinSize().w / tile;
 	for(int i = 1; i < n; i++){
-		land.addItem();
-		land.setActiveID(i);
+		tiles.push_back(land.addItem());
 		land.setBound({tile * i, app.getWinSize().h - tile, tile, tile});
 		if(i == n - 1){
 			land.draw("res/assets/land3.png");
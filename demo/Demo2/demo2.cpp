@@ -12,49 +12,77 @@ zfont fonts;
 // create event objects
 Event e;
 
-// function to load fonts
-void loadFonts(){	
-	fonts.loadFont("NotoSans", 24, "res/fonts/NotoSans-Regular.ttf");
+// assets listed in res/demo2.manifest, loaded in parallel before the first frame
+zmanifest assets(app.getRenderer(), fonts);
+
+// function to load fonts and nav icons
+void loadAssets(){
+	if(assets.load("res/demo2.manifest")) assets.wait();
+	assets.printReport();
 }
 
 // parameters app run
 bool isRun = true;
 
-// paths of nav btn assets
-vector<string> path = {
-	"res/assets/home.png",
-	"res/assets/call.png",
-	"res/assets/discover.png",
-	"res/assets/setting.png"
-};
+// names of nav btn assets in the manifest
+vector<string> icons = {"home", "call", "discover", "setting"};
+
+// layout of the window: background fills it, nav buttons stack in a column on the left
+zlayout ui;
+LayoutNode navColumn;
+vector<LayoutNode> navNodes;
 
-// func to create layout
+// func to create layout, the nine-slice background is resized by ui, never redrawn
 void buildLayout(zbj& _zbj) {
 	_zbj.setAnchorPt(AnchorType::ANCHOR_BOT_RIGHT);
-	_zbj.setBound({app.getWinSize().w + 16, app.getWinSize().h + 16, app.getWinSize().w - 72, app.getWinSize().h + 8});
 	_zbj.setColor(Hex("#1E1E1E"));
+
+	LayoutSpec bg;
+	bg.anchor = AnchorType::ANCHOR_BOT_RIGHT;
+	bg.x = Px(16); bg.y = Px(16);
+	bg.w = Percent(100, -72); bg.h = Percent(100, 8);
+	ui.bind(ui.add(LAYOUT_ROOT, bg), _zbj);
+	// rasterize at the laid out size, the corner radius is relative to it
+	ui.update();
 	_zbj.draw(0.05); // Background
+
+	LayoutSpec column;
+	column.y = Px(43);
+	column.w = Px(86);
+	column.flex = FlexDirection::COLUMN;
+	navColumn = ui.add(LAYOUT_ROOT, column);
 }
 
 // func to create nav btn
 void buildNav(zbj& _zbj, int id){
+	_zbj.setPacked(true);
+	_zbj.setCached(true); // button + icon composited once, shown as one quad
 	_zbj.setColor(Hex("#3c3c3c"));
-	_zbj.setBound({43, 86*(id + 1), 86, 86});
+	_zbj.setBound({0, 0, 86, 86});
 	_zbj.draw(0.25);
 	_zbj.setAnchorPt(AnchorType::ANCHOR_CENTER);
 
 	_zbj.addItem();
-	_zbj.draw(path[id].c_str());
+	_zbj.draw(assets.getPath(icons[id]));
 	Bound b = _zbj.getBounds().back().origin;
-	b.x = _zbj.getBounds().front().origin.x;
-	b.y = _zbj.getBounds().front().origin.y;
 	b.w *= 1.5; b.h *= 1.5;
 	_zbj.setBound(b);
+
+	// button takes the next 86px of the column, the icon is centered in it at its own size
+	LayoutSpec btn;
+	btn.h = Px(86);
+	navNodes.push_back(ui.add(navColumn, btn));
+	ui.bind(navNodes.back(), _zbj, 0);
+	LayoutSpec icon;
+	icon.anchor = AnchorType::ANCHOR_CENTER;
+	icon.w = Content(); icon.h = Content();
+	ui.bind(ui.add(navNodes.back(), icon), _zbj, 1);
 }
 
 // func to set pos and create nav Active
 void setPosNavActive(zbj& _zbj, int id){
-	_zbj.setBound({0, 86 * (id + 1), 24, 86});
+	const Bound& btn = ui.getBox(navNodes[id]);
+	_zbj.setBound({btn.x, btn.y + btn.h / 2, 24, 86});
 	if(!_zbj.getTextures().front()){
 		_zbj.setColor(Hex("#65E10F"));
 		_zbj.draw(1);
@@ -63,12 +91,14 @@ void setPosNavActive(zbj& _zbj, int id){
 }
 
 int main(){
-	// load fonts
-	loadFonts();
+	// load fonts and icons
+	loadAssets();
 
 	// update window size
 	app.updateWinSize();
+	app.setTargetFPS(60);
 	app.setWindowIcon("res/assets/app-icon.png");
+	ui.setSize(app.getWinSize().w, app.getWinSize().h);
 
 	// create layout obj
 	zbj layout(app.getRenderer());
@@ -86,46 +116,46 @@ int main(){
 
 	zbj navSetting(app.getRenderer());
 	buildNav(navSetting, 3);
+	ui.update();
 
 	// create nav active obj
 	zbj navActive(app.getRenderer());
 	setPosNavActive(navActive, 0);
 
-	// create sequence follow up for nav btn
-	vector<zFlow> navHovers = {
-		{[&](){return isHover(getMousePos(), navHome.getRealBound(0));}, 
-			[&](){ return navHome.show(); }, [&](){ return navHome.show(1);}},
-		{[&](){return isHover(getMousePos(), navCall.getRealBound(0));}, 
-			[&](){ return navCall.show(); }, [&](){ return navCall.show(1);}},
-		{[&](){return isHover(getMousePos(), navDiscover.getRealBound(0));}, 
-			[&](){ return navDiscover.show(); }, [&](){ return navDiscover.show(1);}},
-		{[&](){return isHover(getMousePos(), navSetting.getRealBound(0));}, 
-			[&](){ return navSetting.show(); }, [&](){ return navSetting.show(1);}},
-	};
+	// nav buttons are found by the hit index, the events reach only the button under the pointer
+	zhit hits;
+	zinput input(hits);
+	vector<zbj*> navs = {&navHome, &navCall, &navDiscover, &navSetting};
+	vector<bool> navHovered(navs.size(), false);
+	for(size_t i = 0; i < navs.size(); i++){
+		hits.add(*navs[i]);
+		input.on(*navs[i], PointerKind::ENTER, [&, i](const PointerEvent&){ navHovered[i] = true; });
+		input.on(*navs[i], PointerKind::LEAVE, [&, i](const PointerEvent&){ navHovered[i] = false; });
+		input.on(*navs[i], PointerKind::CLICK, [&, i](const PointerEvent&){ setPosNavActive(navActive, i); });
+	}
 
-	// create sequence follow up for nav Active
-	vector<zFlow> navActiveFollowUps = {
-		{[&](){ return isOnClick(e, navHome.getRealBound(0));}, [&](){ setPosNavActive(navActive, 0);}, [](){}},
-		{[&](){ return isOnClick(e, navCall.getRealBound(0));}, [&](){ setPosNavActive(navActive, 1);}, [](){}},
-		{[&](){ return isOnClick(e, navDiscover.getRealBound(0));}, [&](){ setPosNavActive(navActive, 2);}, [](){}},
-		{[&](){ return isOnClick(e, navSetting.getRealBound(0));}, [&](){ setPosNavActive(navActive, 3);}, [](){}}
+	input.on(SDL_EVENT_QUIT, [](const Event&){ isRun = false; });
+	auto resize = [&](const Event&){
+		app.updateWinSize();
+		ui.setSize(app.getWinSize().w, app.getWinSize().h);
 	};
+	input.on(SDL_EVENT_WINDOW_MAXIMIZED, resize);
+	input.on(SDL_EVENT_WINDOW_RESTORED, resize);
 
 	// main loop of app
 	while(isRun){
+		input.poll(); // events are pumped once per frame
+		app.pump(); // finished asset loads
+		ui.update(); // only the background box depends on the window size
 		app.clearRender(Hex("#111111"));
 		layout.show();
-		for(auto& f : navHovers){ f.execute(); }
-		while(SDL_PollEvent(&e)){
-			if(e.type == SDL_EVENT_QUIT){ isRun = false; }
-			if(e.type == SDL_EVENT_WINDOW_MAXIMIZED){ app.updateWinSize(); }
-			if(e.type == SDL_EVENT_WINDOW_RESTORED){ app.updateWinSize(); }
-			if(e.type == SDL_EVENT_WINDOW_MINIMIZED){ continue; }
-			for(auto& f : navActiveFollowUps){ f.execute(); }
+		for(size_t i = 0; i < navs.size(); i++){
+			if(navHovered[i]) navs[i]->show();
+			else navs[i]->show(1);
 		}
 		navActive.show();
 		app.present();
-		app.delay(1000/60);
+		app.pace();
 	}
 
 	return 0;
@@ -0,0 +1,47 @@
+// zatlas.h
+#pragma once
+#include <vector>
+#include "zenv.h"
+
+struct AtlasRegion {
+    Texture page;
+    FBound src;
+};
+
+// Packs small surfaces into a few large textures per renderer (skyline bottom-left).
+class zatlas {
+private:
+    struct Skyline {
+        int x, y, w;
+    };
+
+    struct Page {
+        Texture texture;
+        std::vector<Skyline> skyline;
+        size_t live;
+    };
+
+    Renderer renderer;
+    int pageSize;
+    int maxRegion;
+    std::vector<Page> pages;
+
+    bool newPage();
+    bool fit(const Page& p, size_t index, int w, int h, int& y) const;
+    bool place(Page& p, int w, int h, Bound& out);
+
+public:
+    zatlas(Renderer renderer, int pageSize = 1024, int maxRegion = 256);
+    ~zatlas();
+
+    // One atlas per renderer, created on first use
+    static zatlas& get(Renderer renderer);
+    static void drop(Renderer renderer);
+
+    bool pack(Surface s, AtlasRegion& out);
+    bool release(Texture page);
+    void clear();
+
+    size_t getPageCount() const;
+    int getMaxRegion() const;
+};
@@ -0,0 +1,38 @@
+// zbatch.h
+#pragma once
+#include <vector>
+#include "zenv.h"
+
+// Collects consecutive quads that share a texture and submits them with one SDL_RenderGeometry call.
+// Submission order is kept: a quad with a different texture flushes the pending run first.
+class zbatch {
+private:
+    Renderer renderer;
+    Texture texture;            // texture of the pending run, nullptr for untextured geometry
+    float texW, texH;
+    std::vector<SDL_Vertex> vertices;
+    std::vector<int> indices;
+    bool enabled;
+    size_t drawCalls;           // submitted during the current frame
+    size_t lastDrawCalls;       // submitted during the last presented frame
+
+    void begin(Texture t);
+
+public:
+    zbatch(Renderer renderer);
+
+    // One batch per renderer, created on first use
+    static zbatch& get(Renderer renderer);
+    static void drop(Renderer renderer);
+
+    void push(Texture t, const FBound* src, const FBound& dst);
+    void pushNine(Texture t, const FBound* src, float inset, const FBound& dst);
+    void pushRect(const FBound& dst, Color color);
+    void pushFan(const std::vector<FPoint>& ring, const FBound& dst, Color color);
+    void flush();
+    void endFrame();
+    void setEnabled(bool enable);
+
+    size_t getDrawCalls() const;
+    size_t getPendingDrawCalls() const;
+};
@@ -5,8 +5,16 @@
 #include <vector>
 #include <iostream>
 #include <cstring>
+#include <string>
+#include <functional>
 #include "zenv.h"
 
+class zbatch;
+class zhit;
+
+// Draws an item's content itself, given the batch and the item's placed bound
+using Painter = std::function<void(zbatch& batch, const FBound& dst)>;
+
 enum class AnchorType {
     ANCHOR_TOP_LEFT,
     ANCHOR_TOP_MID,
@@ -24,14 +32,106 @@ struct Anchor {
     Point current;
 };
 
+enum class RecipeKind {
+    NONE,
+    SHAPE,  // draw(radiusScale)
+    LINE,   // drawLine()
+    TEXT,   // draw(font, text, pos, wrapWidth)
+    IMAGE   // draw(path) / drawAsync(path)
+};
+
+// How an item's texture was made, enough to draw it again after ztexbudget evicted it
+struct Recipe {
+    RecipeKind kind;
+    Color color;
+    float radiusScale;
+    Font font;
+    std::string source;     // string for TEXT, path for IMAGE
+    int wrapWidth;
+    bool packed;
+    int w, h;               // bound size at draw time
+};
+
+struct Item {
+    FBound src;     // region of the texture to draw, empty means the whole texture
+    float slice;    // nine-slice corner size in pixels, 0 stretches the whole texture
+
+    // Primitive items keep only geometry and color, they own no texture
+    bool prim;
+    Color fill;
+    float radius;
+    std::vector<FPoint> mesh;   // rounded outline relative to the item origin
+    int meshW, meshH;           // size the mesh was built for
+
+    Text text;      // shaped string drawn from the text engine's glyph atlas, owns no texture
+    Painter painter;    // custom content (e.g. ztextfield), owns no texture
+    std::string pending;    // image path still decoding in zloader, drawn as a prim placeholder until then
+
+    Recipe recipe;
+    Uint64 ticket;  // ztexbudget entry of the texture, 0 when not tracked
+    bool evicted;   // texture released by the budget, rebuilt from recipe on the next show()
+    bool deferred;  // recorded by a lazy draw call, rasterized by the first show() that renders it
+};
+
+// Stable reference to a zbj item: its slot plus the generation the slot had when the item was
+// added, so a handle to a removed item never resolves to whatever reused the slot
+struct ItemHandle {
+    Uint32 index;
+    Uint32 generation;
+};
+
+constexpr ItemHandle INVALID_ITEM = { 0, 0 };  // generations start at 1
+
 class zbj {
 private:
+    struct Slot {
+        Uint32 generation;  // bumped each time the slot is handed out
+        Uint32 prev, next;  // draw order, NO_SLOT at either end
+        Uint64 order;       // rank in draw order, a later item is drawn on top
+        bool alive;
+    };
+    static constexpr Uint32 NO_SLOT = 0xFFFFFFFF;
+
     std::vector<Anchor> bounds;
     Color color;
     Renderer renderer;
     std::vector<Texture> textures;
     size_t ID;
     std::vector<AnchorType> anchor;
+    std::vector<Item> items;
+    bool packed;
+    bool dirty;     // something visible changed since the last markClean()
+    Bound shown;    // extent at the last markClean(), repainted when the object moves away
+    bool cached;        // show() draws one composited layer instead of every item
+    bool layerDirty;
+    Texture layer;
+    Bound layerExtent;
+    bool lazy;          // draw calls record a recipe, show() rasterizes it
+    bool reshaped;      // a deferred image took its decoded size during show(), dirty past markClean()
+    // bounds, textures, anchor and items are indexed by slot; a removed item leaves an empty slot
+    // for the next add, so IDs never shift and add/remove are O(1)
+    std::vector<Slot> slots;
+    std::vector<Uint32> freeSlots;
+    Uint32 head, tail;  // first and last item in draw order
+    size_t count;
+    Uint64 nextOrder;
+    zhit* hits;         // hit index told about every item that moves, nullptr when not registered
+
+    bool commit(Surface s);
+    void releaseTexture(size_t index);
+    void releaseText(size_t index);
+    void submit(size_t index, zbatch& batch, FPoint offset = { 0.0f, 0.0f });
+    void touch();
+    bool buildLayer();
+    void destroyLayer();
+    void resolve(const std::string& path, Surface s);
+    void dropWaiter(size_t index);
+    void track(size_t index, size_t bytes, Texture shared = nullptr);
+    void record(RecipeKind kind, float radiusScale = 0.0f, const Font font = nullptr, const char* source = "", int wrapWidth = 0);
+    bool regenerate(size_t index);
+    bool defer(RecipeKind kind, float radiusScale = 0.0f, const Font font = nullptr, const char* source = "", int wrapWidth = 0);
+    size_t allocSlot();
+    void freeSlot(size_t index);
 
 public:
     zbj(Renderer renderer);
@@ -41,8 +141,13 @@ public:
     // Drawing functions
     bool drawLine();
     bool draw(float radiusScale = 0.0f);
-    bool draw(const Font font, const char* text, Point pos);
+    bool draw(const Font font, const char* text, Point pos, int wrapWidth = 0);
     bool draw(const char* path);
+    bool drawAsync(const char* path);
+    bool drawText(const Font font, const char* text, Point pos);
+    bool setText(const char* text);
+    bool drawWith(Painter painter);
+    bool fill(float radiusScale = 0.0f);
     
     // Item management
     bool clearItems();
@@ -50,14 +155,39 @@ public:
     bool show();
     void setBound(const Bound& newBound);
     void setColor(const Color& newColor);
-    void addItem();
+    ItemHandle addItem();
+    size_t addItems(size_t n, std::vector<ItemHandle>* handles = nullptr);
     bool removeItem(size_t index);
+    bool removeItem(ItemHandle handle);
+    size_t removeItems(const std::vector<ItemHandle>& handles);
+    void reserve(size_t n);
     void setActiveID(size_t newID);
+    bool setActive(ItemHandle handle);
     void setAnchorPt(AnchorType anchor);
+    void setPacked(bool enable);
+    void setCached(bool enable);
+    void setLazy(bool enable);
+    void markDirty();
+    void markClean();
+    void evict(size_t index, Uint64 ticket);
+    void setHitIndex(zhit* index);
     
     // Getters
 	const Bound getRealBound(size_t index) const;
+    AnchorType getAnchor(size_t index) const;
+    bool isDrawn(size_t index) const;
+    bool isAlive(size_t index) const;
+    bool isValid(ItemHandle handle) const;
+    ItemHandle getHandle(size_t index) const;
+    Uint64 getOrder(size_t index) const;
+    size_t getCount() const;
+    bool isPending(size_t index) const;
+    bool isDirty() const;
+    Bound getExtent() const;
+    const Bound& getShownExtent() const;
+    bool getDamage(Bound& damage) const;
     const size_t& getID() const;
     const std::vector<Anchor>& getBounds() const;
     const std::vector<Texture>& getTextures() const;
+    const std::vector<Item>& getItems() const;
 };
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include "SDL3/SDL_ttf.h"
 
 using Font = TTF_Font*;
+using Text = TTF_Text*;
 using Bound = SDL_Rect;
 using FBound = SDL_FRect;
 using Point = SDL_Point;
@@ -4,19 +4,42 @@
 #include <iostream>
 #include "zenv.h"
 
-struct FontData{
-	Font font;
+// Index into the registry's size table, stable for the registry's lifetime
+using FontHandle = int;
+constexpr FontHandle INVALID_FONT = -1;
+
+struct FontFile{
+	void* data;     // whole file, read once and shared by every size; nullptr while loading
 	size_t size;
-}; using Fonts = std::unordered_map<std::string, FontData>;
+	bool owned;     // false when data points into a mounted zpack
+};
+
+struct FontSlot{
+	size_t file;
+	int size;
+	Font font;      // opened on first get()
+};
 
 class zfont{
 	private:
-		Fonts fonts;
+		std::vector<FontFile> files;
+		std::unordered_map<std::string, size_t> filesByPath;
+		std::unordered_map<std::string, size_t> families;   // name -> file
+		mutable std::vector<FontSlot> slots;   // sizes are opened on first use, also from const lookups
+
+		bool open(FontSlot& slot) const;
+		FontHandle find(const std::string& name, int size) const;
+		bool addPacked(const std::string& path);
 
 	public:
 		zfont();
 		bool loadFont(const std::string& name, size_t size, const std::string& path);
+		bool loadFontAsync(const std::string& name, size_t size, const std::string& path);
+		bool adoptFont(const std::string& name, const std::string& path, void* data, size_t bytes);
+		FontHandle getHandle(const std::string& name, int size);
+		Font get(FontHandle handle);
+		bool isReady(FontHandle handle) const;
 		const Font getFont(const std::string& name, int size) const;
 		bool cleanUpFonts();
 		~zfont();
-};
\ No newline at end of file
+};
@@ -0,0 +1,59 @@
+// zhit.h
+#pragma once
+#include <unordered_map>
+#include <vector>
+#include "zenv.h"
+#include "zbj.h"
+
+struct HitResult {
+    zbj* obj;
+    size_t item;
+};
+
+// Uniform grid of the real bounds of every drawn item of the registered objects. zbj reports
+// each item it changes, so the grid stays current as items move and a pointer query only tests
+// the items sharing its cell instead of every widget. The topmost hit is the highest z, then
+// the object registered last, then the item last in zbj's draw order.
+class zhit {
+private:
+    struct Entry {
+        zbj* obj;
+        size_t item;
+        Bound bound;
+    };
+    struct Registered {
+        int z;
+        Uint64 order;
+        std::vector<Uint32> entries;    // by item ID, NO_ENTRY when not indexed
+    };
+    static constexpr Uint32 NO_ENTRY = 0xFFFFFFFF;
+
+    int cellSize;
+    std::unordered_map<Uint64, std::vector<Uint32>> cells;
+    std::unordered_map<zbj*, Registered> objects;
+    std::vector<Entry> entries;
+    std::vector<Uint32> freeEntries;
+    Uint64 nextOrder;
+
+    void insertCells(Uint32 id);
+    void eraseCells(Uint32 id);
+    void erase(Registered& reg, size_t item);
+    bool above(const Entry& a, const Entry& b) const;
+
+public:
+    zhit(int cellSize = 64);
+    ~zhit();
+    zhit(const zhit&) = delete;
+    zhit& operator=(const zhit&) = delete;
+
+    void add(zbj& obj, int z = 0);
+    bool remove(zbj& obj);
+    void setZ(zbj& obj, int z);
+    void update(zbj& obj, size_t item);
+
+    bool hit(FPoint p, HitResult& out) const;
+    size_t hitAll(FPoint p, std::vector<HitResult>& out) const;
+
+    bool has(const zbj& obj) const;
+    size_t size() const;
+};
@@ -0,0 +1,104 @@
+// zinput.h
+#pragma once
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include "zenv.h"
+#include "zbj.h"
+#include "zhit.h"
+
+using Subscription = Uint64;
+constexpr Subscription INVALID_SUBSCRIPTION = 0;
+constexpr size_t ANY_ITEM = static_cast<size_t>(-1);
+
+enum class PointerKind {
+    ENTER,      // the pointer moved onto the region
+    LEAVE,      // the pointer moved off the region
+    PRESS,      // a button went down over the region
+    RELEASE,    // a button pressed over the region went up, anywhere
+    CLICK,      // a button went down and up over the same region
+    DRAG,       // the pointer moved while a button pressed over the region is held
+    COUNT
+};
+
+struct PointerEvent {
+    zbj* obj;
+    size_t item;        // topmost item under the pointer, the pressed one for RELEASE and DRAG
+    FPoint pos;
+    FPoint delta;       // movement since the last motion event, DRAG only
+    FPoint start;       // where the button went down, RELEASE, CLICK and DRAG only
+    Uint8 button;       // 0 for ENTER and LEAVE
+};
+
+// Snapshot taken once per poll(), read it instead of calling SDL_GetMouseState per widget
+struct InputState {
+    FPoint mouse;
+    SDL_MouseButtonFlags buttons;
+    SDL_Keymod mods;
+    const bool* keys;   // indexed by SDL_Scancode
+    bool hasFocus;      // the pointer is inside the window
+};
+
+using EventCallback = std::function<void(const Event& e)>;
+using PointerCallback = std::function<void(const PointerEvent& e)>;
+
+// Pumps SDL once per frame and routes every event only to its subscribers: by event type, or
+// for pointer events by region, a zbj item found through the zhit index. A frame then costs one
+// hit query per pointer event plus the callbacks that are actually interested, however many
+// widgets are on screen. Call off(obj) before a subscribed zbj is destroyed.
+class zinput {
+private:
+    struct TypeSub {
+        Subscription id;
+        EventCallback cb;   // id is INVALID_SUBSCRIPTION once unsubscribed, dropped after dispatch
+    };
+    struct PointerSub {
+        Subscription id;
+        size_t item;        // ANY_ITEM for the whole object
+        PointerCallback cb;
+    };
+    struct Region {
+        std::deque<PointerSub> subs[static_cast<int>(PointerKind::COUNT)];
+    };
+    struct Target {
+        zbj* obj;
+        size_t item;
+    };
+
+    zhit& hits;
+    std::unordered_map<Uint32, std::deque<TypeSub>> types;
+    std::unordered_map<zbj*, Region> regions;
+    std::vector<Event> queue;
+    InputState state;
+    Target hover;
+    Target pressed;
+    Uint8 pressedButton;
+    FPoint pressPos;
+    Subscription nextID;
+    int depth;          // nested dispatches, subscriptions are only erased at depth 0
+    bool stale;         // some subscription was removed during a dispatch
+
+    void retarget(FPoint pos);
+    void deliver(const Target& t, PointerKind kind, const PointerEvent& e, bool toAny = true, bool toItem = true);
+    void pointer(const Event& e);
+    void prune();
+
+public:
+    zinput(zhit& hits);
+    zinput(const zinput&) = delete;
+    zinput& operator=(const zinput&) = delete;
+
+    Subscription on(Uint32 type, EventCallback cb);
+    Subscription on(zbj& obj, PointerKind kind, PointerCallback cb, size_t item = ANY_ITEM);
+    void off(Subscription id);
+    void off(zbj& obj);
+
+    size_t poll();
+    bool wait(Sint32 timeoutMS = -1);
+    void dispatch(const Event& e);
+
+    const InputState& getState() const;
+    bool isHovered(const zbj& obj, size_t item = ANY_ITEM) const;
+    bool isPressed(const zbj& obj, size_t item = ANY_ITEM) const;
+};
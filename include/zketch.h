@@ -2,6 +2,20 @@
 #pragma once
 #include "zbj.h"
 #include "zfont.h"
+#include "ztextengine.h"
+#include "ztextfield.h"
+#include "ztexcache.h"
+#include "ztexbudget.h"
+#include "zloader.h"
+#include "zmanifest.h"
+#include "zpack.h"
+#include "zatlas.h"
+#include "zbatch.h"
+#include "zscene.h"
+#include "zlayout.h"
+#include "zhit.h"
+#include "zinput.h"
+#include "zprof.h"
 #include "zevent.h"
 #include "zmain.h"
 #include "utils.h"
\ No newline at end of file
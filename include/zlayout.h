@@ -0,0 +1,87 @@
+// zlayout.h
+#pragma once
+#include <vector>
+#include "zenv.h"
+#include "zbj.h"
+
+using LayoutNode = int;
+constexpr LayoutNode LAYOUT_ROOT = 0;
+constexpr LayoutNode INVALID_NODE = -1;
+
+// A size or offset: px plus a percentage of the parent's inner size, or the node's measured
+// content size (text, images) when content is set
+struct Length {
+    float px;
+    float percent;
+    bool content;
+};
+
+inline Length Px(float v) { return { v, 0.0f, false }; }
+inline Length Percent(float p, float v = 0.0f) { return { v, p, false }; }
+inline Length Content() { return { 0.0f, 0.0f, true }; }
+
+enum class FlexDirection {
+    NONE,   // children are placed by their own anchor and offset
+    ROW,    // children follow each other left to right
+    COLUMN  // children follow each other top to bottom
+};
+
+struct LayoutSpec {
+    // The same point of the parent's inner box and of the node are pinned together, then moved
+    // by x and y (right and down). In a flex parent the anchor only aligns the cross axis.
+    AnchorType anchor = AnchorType::ANCHOR_TOP_LEFT;
+    Length x = Px(0), y = Px(0);
+    Length w = Percent(100), h = Percent(100);
+    FlexDirection flex = FlexDirection::NONE;
+    float gap = 0.0f;       // between flex children
+    float padding = 0.0f;   // inner box inset for the children
+    float grow = 0.0f;      // share of the free main-axis space of a flex parent
+};
+
+// Tree of boxes computed from parent-relative specs, bound to zbj items. A change marks only the
+// parent whose children have to be placed again; update() places those and walks down only
+// where a box actually changed, so a resize costs what moved rather than the whole UI.
+class zlayout {
+private:
+    struct Binding {
+        zbj* obj;
+        ItemHandle item;    // a slot reused by another item fails isValid(), the binding is dropped
+    };
+    struct Node {
+        LayoutNode parent;
+        std::vector<LayoutNode> children;
+        LayoutSpec spec;
+        Bound box;          // window coordinates, valid after update()
+        int contentW, contentH;
+        int depth;
+        bool dirty;         // children have to be placed again
+        std::vector<Binding> bindings;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<LayoutNode> queue;  // dirty nodes, each once
+    size_t placed;                  // boxes computed by the last update()
+
+    bool valid(LayoutNode node) const;
+    void invalidate(LayoutNode node);
+    void place(LayoutNode node);
+    void apply(Node& n);
+
+public:
+    zlayout(int w = 0, int h = 0);
+
+    LayoutNode add(LayoutNode parent, const LayoutSpec& spec = LayoutSpec());
+    bool setSpec(LayoutNode node, const LayoutSpec& spec);
+    bool setContentSize(LayoutNode node, int w, int h);
+    bool bind(LayoutNode node, zbj& obj, ItemHandle item);
+    bool bind(LayoutNode node, zbj& obj, size_t item = 0);
+    void unbind(zbj& obj);
+    void setSize(int w, int h);
+    size_t update();
+
+    const Bound& getBox(LayoutNode node) const;
+    const LayoutSpec& getSpec(LayoutNode node) const;
+    bool isDirty() const;
+    size_t getPlaced() const;
+    size_t size() const;
+};
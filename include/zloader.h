@@ -0,0 +1,32 @@
+// zloader.h
+#pragma once
+#include <functional>
+#include "zenv.h"
+
+// Surface is nullptr when decoding failed; it is destroyed after the callback returns
+using SurfaceCallback = std::function<void(Surface s)>;
+// data is nullptr when reading failed, otherwise the callback owns it (SDL_free)
+using FileCallback = std::function<void(void* data, size_t size)>;
+
+// Background asset loader: worker threads decode images (IMG_Load) and read files (SDL_LoadFile),
+// then hand the results back through a lock-free stack. Callbacks only ever run on the main
+// thread inside pump(), called once per loop through zmain::pump(), so GPU uploads stay on the render thread.
+// Requests for a path already in flight share one decode. Workers start on the first request.
+// Results waiting to be pumped push an event of getEventType(), so a loop blocked in
+// zmain::waitEvent() wakes up for them without polling.
+class zloader {
+public:
+    static constexpr Uint64 PUMP_BUDGET_NS = 4 * SDL_NS_PER_MS;
+
+    static void start(size_t threads = 0);  // 0 picks from the core count
+    static void stop();
+
+    static bool loadSurface(const char* path, const void* owner, SurfaceCallback done);
+    static bool loadFile(const char* path, const void* owner, FileCallback done);
+    static void cancel(const void* owner);
+    static void cancel(const void* owner, const char* path);
+    static size_t pump(Uint64 budgetNS = PUMP_BUDGET_NS);
+
+    static size_t getPending();
+    static Uint32 getEventType();
+};
@@ -1,19 +1,39 @@
 // zmain.h
 #pragma once
 #include <iostream>
+#include <vector>
 #include "zenv.h"
 
+class zscene;
+
 struct WinData {
     const char* title;
     int w, h;
     SDL_WindowFlags flags;
 };
 
+struct FrameStats {
+    Uint64 frames;
+    Uint64 missed;      // frames whose work overran the target frame time
+    Uint64 workNS;      // last frame, from the end of the previous pace() to this one
+    Uint64 frameNS;     // last frame including the sleep
+};
+
 class zmain {
 private:
     Window window;
     Renderer renderer;
     WinData wd;
+    bool software;              // SDL's software renderer draws straight into the window surface
+    bool partial;
+    bool hud;
+    std::vector<Bound> damage;
+    Uint64 targetNS;            // 0 = no frame limit
+    int vsync;
+    Uint64 frameStart;
+    FrameStats stats;
+
+    bool renderDamage(zscene& scene, Color color, bool& ok);
 
 public:
     zmain();
@@ -22,9 +42,21 @@ public:
     bool initZketch(const WinData& wd);
     WinData getWinSize() const ;
     Renderer& getRenderer();
+    size_t getDrawCalls() const;
+    bool isSoftware() const;
+	size_t pump();
 	bool present();
 	bool clearRender(Color color);
+	bool render(zscene& scene, Color color);
+	void setPartialRedraw(bool enable);
+	void setProfilerHUD(bool enable);
+	void setTextureBudget(size_t bytes);
+	bool waitEvent(Event& e, Sint32 timeoutMS = -1);
 	void delay(Uint32 ms);
+	void setTargetFPS(int fps);
+	bool setVSync(int interval);
+	void pace();
+	const FrameStats& getFrameStats() const;
 	void updateWinSize();
 	void setWindowIcon(const char* path);
 	void startTextInput();
@@ -0,0 +1,72 @@
+// zmanifest.h
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "zenv.h"
+#include "zfont.h"
+
+enum class AssetKind {
+    FONT,
+    IMAGE
+};
+
+struct Asset {
+    AssetKind kind;
+    std::string name;
+    std::string path;
+    std::vector<int> sizes;     // fonts only, every size is opened once the file is in
+    bool pack;                  // images only, uploaded into the zatlas for zbj objects with setPacked(true)
+    std::string after;          // name of an asset that has to finish first, empty for none
+    bool requested;
+    bool done;
+    bool ok;
+    Uint64 requestNS;           // when the file went to zloader
+    Uint64 loadNS;              // request to delivery: queueing, reading and decoding
+    Uint64 finishNS;            // main thread work after delivery: texture upload or font open
+};
+
+// Asset list read from a manifest file and preloaded in parallel through zloader's workers.
+// Every asset without an `after` dependency is requested at once; the others are requested
+// as soon as the asset they name is in. Images end up resident in ztexcache, so a later
+// zbj::draw(path) is a cache hit; fonts are registered in the given zfont with their sizes open.
+// Assets found in a mounted zpack skip the workers, they need no reading or decoding.
+//
+// Manifest lines, '#' starts a comment:
+//   font  <name> <path> <size> [size...] [after=<name>]
+//   image <name> <path> [pack] [after=<name>]
+class zmanifest {
+private:
+    Renderer renderer;
+    zfont& fonts;
+    std::vector<Asset> assets;
+    std::unordered_map<std::string, size_t> byName;
+    size_t finished;
+    size_t failed;
+    Uint64 startNS, endNS;
+
+    void request(size_t index);
+    void complete(size_t index);
+    void finishFont(size_t index, void* data, size_t size);
+    void finishImage(size_t index, Surface s);
+    bool openSizes(const Asset& asset);
+    bool preload(const Asset& asset, Surface s);
+
+public:
+    zmanifest(Renderer renderer, zfont& fonts);
+    ~zmanifest();
+    zmanifest(const zmanifest&) = delete;
+    zmanifest& operator=(const zmanifest&) = delete;
+
+    bool load(const char* path);
+    bool add(const Asset& asset);
+    bool start();
+    bool wait();
+
+    bool isDone() const;
+    float getProgress() const;
+    const char* getPath(const std::string& name) const;
+    const std::vector<Asset>& getAssets() const;
+    Uint64 getTotalNS() const;
+    void printReport() const;
+};
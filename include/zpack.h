@@ -0,0 +1,57 @@
+// zpack.h
+#pragma once
+#include <string>
+#include "zenv.h"
+
+// On-disk layout, little-endian: PackHeader, `count` PackEntry records, the name blob,
+// then the payloads, each aligned to PACK_ALIGN from the start of the file.
+constexpr char PACK_MAGIC[4] = { 'Z', 'K', 'P', 'K' };
+constexpr Uint32 PACK_VERSION = 1;
+constexpr Uint64 PACK_ALIGN = 16;
+
+enum class PackKind : Uint32 {
+    IMAGE = 1,  // decoded pixels, ready for SDL_CreateTextureFromSurface
+    FILE = 2    // raw file bytes, e.g. fonts opened through SDL_IOFromConstMem
+};
+
+struct PackHeader {
+    char magic[4];
+    Uint32 version;
+    Uint32 count;
+    Uint32 namesSize;
+};
+
+struct PackEntry {
+    Uint64 offset;      // from the start of the file
+    Uint64 size;
+    Uint32 nameOffset;  // into the name blob
+    Uint32 nameLength;
+    Uint32 kind;        // PackKind
+    Uint32 format;      // SDL_PixelFormat for images, 0 for files
+    Uint32 w, h, pitch;
+    Uint32 reserved;
+};
+
+static_assert(sizeof(PackHeader) == 16, "PackHeader layout is part of the file format");
+static_assert(sizeof(PackEntry) == 48, "PackEntry layout is part of the file format");
+
+struct PackAsset {
+    const PackEntry* entry;
+    const Uint8* data;      // inside the mapping, valid while the pack stays mounted
+};
+
+// Read-only asset packs built by zketch-pack, memory-mapped so lookups cost no file opens and
+// image pixels need no decoding. Entries are named by the path the app already uses
+// ("res/assets/home.png"); ztexcache and zfont look there before touching the file system.
+// Packs mounted later win over earlier ones.
+class zpack {
+public:
+    static bool mount(const char* path);
+    static bool unmount(const char* path);
+    static void unmountAll();
+
+    static bool find(const char* name, PackAsset& out);
+    static Surface surface(const PackAsset& asset);
+    static std::string normalize(const char* path);
+    static size_t getMounted();
+};
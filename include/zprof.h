@@ -0,0 +1,64 @@
+// zprof.h
+#pragma once
+#include <vector>
+#include "zenv.h"
+
+enum class ProfSection {
+    CLEAR,
+    SHOW,
+    DRAW,       // shape and image rasterization in zbj::draw*/fill
+    TEXT,       // TTF rendering in zbj::draw(Font, ...)
+    UPLOAD,     // surface to texture uploads, nested inside DRAW/TEXT
+    PRESENT,
+    COUNT
+};
+
+struct FrameRecord {
+    Uint64 frameNS;                                             // present to present
+    Uint64 sectionNS[static_cast<size_t>(ProfSection::COUNT)];  // inclusive time per section
+    size_t drawCalls;
+    size_t texturesCreated;
+};
+
+struct ProfSummary {
+    size_t frames;      // records in the ring
+    float fps;
+    float p50MS, p99MS;
+    float sectionMS[static_cast<size_t>(ProfSection::COUNT)];   // mean per frame
+    size_t drawCalls;       // last frame
+    size_t texturesCreated; // last frame
+};
+
+// Frame profiler: scoped timers accumulate into the current frame's record, and zmain
+// closes the record on every present into a ring of the last CAPACITY frames.
+// Disabled by default; a disabled scope costs one branch.
+class zprof {
+public:
+    static constexpr size_t CAPACITY = 600;
+
+    class Scope {
+    private:
+        ProfSection section;
+        Uint64 start;
+    public:
+        Scope(ProfSection section);
+        ~Scope();
+    };
+
+    static void setEnabled(bool enable);
+    static bool isEnabled();
+    static void add(ProfSection section, Uint64 ns);
+    static void countTexture();
+    static void endFrame(size_t drawCalls);
+    static void reset();
+
+    static ProfSummary getSummary();
+    static const std::vector<FrameRecord>& getRecords();   // ring order, see getHead()
+    static size_t getHead();
+    static bool drawHUD(Renderer renderer, float x = 8.0f, float y = 8.0f);
+    static bool dumpCSV(const char* path);
+};
+
+#define ZPROF_CONCAT_(a, b) a##b
+#define ZPROF_CONCAT(a, b) ZPROF_CONCAT_(a, b)
+#define ZPROF_SCOPE(section) zprof::Scope ZPROF_CONCAT(zprofScope, __LINE__)(section)
@@ -0,0 +1,13 @@
+// zraster.h
+#pragma once
+#include "zenv.h"
+
+// Software rasterizers writing straight-alpha SDL_PIXELFORMAT_RGBA32 pixels.
+class zraster {
+public:
+    static Uint32 pixel(Color color, Uint8 alpha);
+    static void fillRow(Uint32* row, int count, Uint32 pixel);
+
+    // Anti-aliased rounded rectangle covering the whole w*h buffer; pitch is in bytes
+    static void roundRect(void* pixels, int pitch, int w, int h, float radius, Color color);
+};
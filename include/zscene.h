@@ -0,0 +1,45 @@
+// zscene.h
+#pragma once
+#include <memory>
+#include <vector>
+#include "zenv.h"
+#include "zbj.h"
+
+// Retained list of zbj nodes drawn in z order. The scene is dirty when a node changed,
+// when nodes were added/removed/reordered, or after invalidate(); zmain::render() skips
+// clearing and presenting while it is clean. Besides the flag the scene keeps the areas that
+// changed, so the software path can repaint just those (see collectDamage()).
+class zscene {
+private:
+    struct Node {
+        zbj* obj;
+        int z;
+        std::unique_ptr<zbj> owned;
+    };
+
+    Renderer renderer;
+    std::vector<Node> nodes;    // sorted by z, insertion order among equal z
+    bool dirty;                 // whole window needs repainting
+    std::vector<Bound> pending; // areas touched by added, removed or reordered nodes
+
+    void insert(Node&& node);
+    void damage(const Bound& area);
+
+public:
+    zscene(Renderer renderer);
+
+    zbj& create(int z = 0);
+    void attach(zbj& obj, int z = 0);
+    bool detach(zbj& obj);
+    void setZ(zbj& obj, int z);
+
+    bool handle(const Event& e);
+    void invalidate();
+    bool isDirty() const;
+    bool collectDamage(std::vector<Bound>& rects) const;
+    void show();
+    void show(const Bound& clip);
+    void markClean();
+
+    size_t size() const;
+};
@@ -0,0 +1,67 @@
+// ztexbudget.h
+#pragma once
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include "zenv.h"
+
+class zbj;
+
+struct TexBudgetStats {
+    size_t bytes;           // textures currently held by tracked items, each texture counted once
+    size_t residents;       // textures, not items
+    size_t evictions;
+    size_t regenerations;
+};
+
+// Texture memory budget for one renderer. zbj registers every texture it owns (shapes, lines,
+// text and images outside the atlas) together with a recipe of how it was drawn. Items shown
+// in a frame move to the front of an LRU list; after present, while the total is over budget,
+// the least recently shown textures are released and the item keeps only its recipe, to be
+// drawn again by the next show() that needs it. Textures shown in the last frame are never
+// evicted, so a frame that needs more than the budget overshoots instead of thrashing.
+// A ztexcache texture held by many items is one resident: charged once, evicted from all of
+// them together, so the cache entry is actually destroyed.
+class ztexbudget {
+private:
+    struct Holder {
+        zbj* owner;
+        size_t item;        // slot of the item in owner, so eviction needs no search
+        Uint64 ticket;
+    };
+    struct Resident {
+        Texture shared;     // cache texture the holders share, nullptr when owned by one item
+        std::vector<Holder> holders;
+        size_t bytes;
+        Uint64 shownFrame;
+    };
+
+    Renderer renderer;
+    size_t budget;          // 0 = unlimited
+    Uint64 frame;
+    Uint64 nextTicket;
+    std::list<Resident> lru;    // most recently shown first
+    std::unordered_map<Uint64, std::list<Resident>::iterator> residents;    // by ticket
+    std::unordered_map<Texture, std::list<Resident>::iterator> shared;
+    TexBudgetStats stats;
+
+    void trim();
+    void erase(std::list<Resident>::iterator it);
+
+public:
+    ztexbudget(Renderer renderer);
+
+    // One budget per renderer, created on first use
+    static ztexbudget& get(Renderer renderer);
+    static void drop(Renderer renderer);
+
+    Uint64 add(zbj* owner, size_t item, size_t bytes, Texture sharedTexture = nullptr);
+    void remove(Uint64 ticket);
+    void touch(Uint64 ticket);
+    void endFrame();
+    void setBudget(size_t bytes);
+    void countRegeneration();
+
+    size_t getBudget() const;
+    const TexBudgetStats& getStats() const;
+};
@@ -0,0 +1,92 @@
+// ztexcache.h
+#pragma once
+#include <list>
+#include <map>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include "zenv.h"
+
+struct TexCacheStats {
+    size_t hits;
+    size_t misses;
+    size_t bytes;
+    size_t entries;
+
+    // Text textures, see acquireText()
+    size_t textHits;
+    size_t textMisses;
+    size_t textEvictions;
+    size_t textBytes;
+    size_t textEntries;
+};
+
+// Shared, reference-counted image textures for one renderer, keyed by canonical path and packing.
+// Rendered strings are memoized too, keyed by font, string, color and wrap width; unreferenced
+// ones stay resident until the text byte budget is exceeded, then the least recently used go first.
+class ztexcache {
+private:
+    struct Entry {
+        Texture texture;
+        FBound src;         // region inside texture (an atlas page when packed)
+        bool packed;
+        size_t refs;
+        size_t bytes;
+    };
+    using Owner = std::tuple<Texture, float, float>;
+    using EntryKey = std::pair<std::string, bool>;          // canonical path, packing asked for
+
+    Renderer renderer;
+    std::map<EntryKey, Entry> entries;                      // a packed and a standalone copy are separate
+    std::unordered_map<std::string, std::string> aliases;   // path as given by caller -> canonical path
+    std::map<Owner, EntryKey> owners;                       // texture + region origin -> entry
+    TexCacheStats stats;
+
+    struct TextKey {
+        Font font;
+        std::string text;
+        Uint32 color;
+        int wrapWidth;
+        bool operator==(const TextKey& o) const;
+    };
+    struct TextKeyHash {
+        size_t operator()(const TextKey& k) const;
+    };
+    struct TextEntry {
+        Texture texture;
+        int w, h;
+        size_t refs;
+        size_t bytes;
+        std::list<const TextKey*>::iterator lru;
+    };
+
+    std::unordered_map<TextKey, TextEntry, TextKeyHash> texts;
+    std::unordered_map<Texture, const TextKey*> textOwners;
+    std::list<const TextKey*> textLRU;                      // most recently used first
+    size_t textBudget;
+
+    const std::string& canonical(const char* path);
+    void destroyEntry(const EntryKey& key);
+    void destroyText(const TextKey& key);
+    void trimText();
+
+public:
+    ztexcache(Renderer renderer);
+    ~ztexcache();
+
+    // One cache per renderer, created on first use
+    static ztexcache& get(Renderer renderer);
+    static void drop(Renderer renderer);
+
+    // packed, when given, tells whether the texture is an atlas page: the atlas may refuse an image
+    Texture acquire(const char* path, FBound& src, bool pack = false, Surface decoded = nullptr, bool* packed = nullptr);
+    Texture find(const char* path, FBound& src, bool pack = false, bool* packed = nullptr);
+    Texture acquireText(const Font font, const char* text, Color color, int wrapWidth, int& w, int& h);
+    bool release(Texture texture, const FBound& src, bool drop = false);
+    void setTextBudget(size_t bytes);
+    void purge();
+    void clear();
+
+    const TexCacheStats& getStats() const;
+};
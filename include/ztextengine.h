@@ -0,0 +1,22 @@
+// ztextengine.h
+#pragma once
+#include "zenv.h"
+
+// SDL_ttf renderer text engine for one renderer. Glyphs are rasterized once per font into the
+// engine's atlas textures; TTF_Text objects created from it are drawn as textured quads.
+class ztextengine {
+private:
+    Renderer renderer;
+    TTF_TextEngine* engine;
+
+public:
+    ztextengine(Renderer renderer);
+    ~ztextengine();
+
+    // One engine per renderer, created on first use
+    static ztextengine& get(Renderer renderer);
+    static void drop(Renderer renderer);
+
+    Text create(const Font font, const char* text, Color color);
+    TTF_TextEngine* getEngine() const;
+};
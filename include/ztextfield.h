@@ -0,0 +1,66 @@
+// ztextfield.h
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "zenv.h"
+#include "zbj.h"
+
+// Single-line text input on top of a zbj: item 0 is the box, item 1 paints glyphs and caret.
+// The text is a gap buffer kept at the caret, so typing, deleting and stepping the caret are O(1).
+// Every codepoint stores its advance, and drawing and hit-testing only walk the visible range,
+// so a keystroke costs the same for 10 or 10000 characters. The visible range is shaped into one
+// TTF_Text of the renderer's ztextengine, so glyphs come from the atlas every text of the font shares.
+class ztextfield {
+private:
+    struct Cell {
+        Uint32 cp;
+        float advance;
+    };
+
+    Renderer renderer;
+    Font font;
+    Color textColor;
+    zbj obj;
+    std::vector<Cell> cells;    // gap buffer, the gap [gapStart, gapEnd) sits at the caret
+    size_t gapStart, gapEnd;
+    float caretX;               // sum of the advances left of the caret
+    float scrollX;              // text offset that keeps the caret inside the box
+    int padding;
+    Uint32 mask;                // 0 shows the text, otherwise every codepoint draws as mask
+    bool focused;
+    std::unordered_map<Uint32, float> advances;
+    Text text;                  // visible range, reshaped when it changes
+    float textX;                // offset of its first cell from the start of the text
+    float shapedWidth;          // inner width the visible range was computed for
+    bool textDirty;
+
+    const Cell& at(size_t index) const;
+    float advance(Uint32 cp);
+    void shape(float inner);
+    void insert(Uint32 cp);
+    void scrollToCaret();
+    void changed();
+    void paint(zbatch& batch, const FBound& dst);
+
+public:
+    ztextfield(Renderer renderer, Font font, Bound bound, Color box, Color text, float radiusScale = 0.0f);
+    ~ztextfield();
+    ztextfield(const ztextfield&) = delete;
+    ztextfield& operator=(const ztextfield&) = delete;
+
+    bool handle(const Event& e);
+    void insert(const char* utf8);
+    bool erase(bool forward = false);
+    void moveCaret(int delta);
+    void setCaret(size_t index);
+    size_t hitTest(int x) const;
+    void setFocus(bool enable);
+    void setMask(Uint32 cp);
+
+    std::string getText() const;
+    size_t getCaret() const;
+    size_t size() const;
+    bool isFocused() const;
+    zbj& getObject();
+};
@@ -9,112 +9,70 @@ zfont fonts;
 Event e;
 bool isRun = true;
 
-Bound bBg;
-Bound bLayout;
-vector<Point> pTitle;
-vector<Point> pTextinForm;
-vector<pair<string, pair<string, int>>> dTextinForm;
+FontHandle fTitle, fSubtitle, fLabel;
 
 void loadFonts(){
-	string parent = "res/fonts/Montserrats/";
-	vector<pair<string, pair<string, int>>> myfont = {
-		{"Montserrat-SemiBold", {"Montserrat-SemiBold.ttf", 36}}, 
-		{"Montserrat-Medium", {"Montserrat-Medium.ttf", 24}}, 
-		{"Montserrat-Light", {"Montserrat-Light.ttf", 20}}
-	};
-	for(auto& f : myfont){
-		string fullPath = parent + f.second.first;
-		fonts.loadFont(f.first, f.second.second, fullPath.c_str());
+	// Every file is read in parallel, the sizes are opened once the files are in
+	zmanifest assets(app.getRenderer(), fonts);
+	if(assets.load("res/main.manifest") && !assets.wait()){
+		cerr << "Error: Some assets failed to load\n";
 	}
+	assets.printReport();
+	// Resolved once, drawing code only indexes the registry
+	fTitle = fonts.getHandle("Montserrat-SemiBold", 36);
+	fSubtitle = fonts.getHandle("Montserrat-Medium", 24);
+	fLabel = fonts.getHandle("Montserrat-Light", 20);
 }
 
+// Objects are drawn once at any position, zlayout places them and moves them on resize
 void setBg(zbj& z){
-	bBg = {0, 0, app.getWinSize().w, app.getWinSize().h};
-	z.setBound(bBg);
 	z.setColor(Hex("7070FA"));
-	z.draw();
+	z.fill();
 }
 
 void setLayout(zbj& z){
-	bLayout = {app.getWinSize().w, 0, app.getWinSize().w / 3, app.getWinSize().h};
-	z.setBound(bLayout);
-	if(!z.getTextures().front()){
-		z.setColor(Hex("303030"));
-		z.setAnchorPt(AnchorType::ANCHOR_TOP_RIGHT);
-		z.draw();
-	}
+	z.setColor(Hex("303030"));
+	z.setAnchorPt(AnchorType::ANCHOR_TOP_RIGHT);
+	z.fill();
 }
 
 void setTextinForm(zbj& z){
-	pTextinForm = {
-		{(int)(app.getWinSize().w * 0.7), app.getWinSize().h / 3},
-		{(int)(app.getWinSize().w * 0.7), app.getWinSize().h / 3 + 50}
-	};
-
-	dTextinForm = {
-		{"Welcome to mySAQ!", {"Montserrat-SemiBold", 36}}, 
-		{"Enter your account details below.", {"Montserrat-Medium", 24}},
+	vector<pair<string, FontHandle>> d = {
+		{"Welcome to mySAQ!", fTitle}, 
+		{"Enter your account details below.", fSubtitle},
 	};
 
-	vector<Point>& p = pTextinForm;
-	vector<pair<string, pair<string, int>>>& d = dTextinForm;
-
 	z.setColor(Hex("#F1F1F1"));
-	if(!z.getTextures().front()){
-		for(size_t i = 0; i < d.size(); i++){
-			z.draw(fonts.getFont(d[i].second.first, d[i].second.second), d[i].first.c_str(), pTextinForm[i]);
-			if(i < d.size() - 1){ z.addItem(); }
-		}
-	}else{
-		for(size_t i = 0; i < z.getBounds().size(); i++){
-			z.setActiveID(i);
-			Bound b = z.getBounds()[i].origin;
-			b.x = p[i].x;
-			b.y = p[i].y;
-			z.setBound(b);
-		}
+	for(size_t i = 0; i < d.size(); i++){
+		z.draw(fonts.get(d[i].second), d[i].first.c_str(), {0, 0});
+		if(i < d.size() - 1){ z.addItem(); }
 	}
 }
 
 void setTitlePH(zbj& z){
-	pTitle = {
-		{(int)(app.getWinSize().w * 0.7), app.getWinSize().h / 3 + 100},
-		{(int)(app.getWinSize().w * 0.7), app.getWinSize().h / 3 + 200}
-	};
 	vector<string> s = {"Username", "Password"};
 
 	z.setColor(Hex("f1f1f1"));
 	for(size_t i = 0; i < s.size(); i++){
-		z.draw(fonts.getFont("Montserrat-Light", 20), s.at(i).c_str(), pTitle.at(i));
+		z.draw(fonts.get(fLabel), s.at(i).c_str(), {0, 0});
 		if(i < s.size() - 1){ z.addItem(); }
 	}
 }
 
-void setPH(zbj& z, Bound b, bool isFocus = false, string s = ""){
-	vector<Color> colors = {Hex("707070"), Hex("9090B0")};
-	Color c = isFocus ? colors.at(1) : colors.at(0);
-
-	if(!z.getTextures().front()){
-		z.setColor(c);
-		z.setBound(b);
-		z.draw(0.5);
-	}
-	if(z.getBounds().size() == 2){
-		z.removeItem(1);
-	}
-	z.addItem();
-	z.setColor(Hex("f1f1f1"));
-	z.draw(fonts.getFont("Montserrat-Light", 20), s.c_str(), {b.x + 15, b.y + int(b.h * 0.30)});
-}
-
-bool clickState2Bool(uint32_t cs){
-	if(cs == 3 && cs == 0){
-		return true;
-	}
-	return false;
+// Node at `y` inside the form, sized by its content (text) or as given
+LayoutNode addFormRow(zlayout& ui, LayoutNode form, float y, Length h = Content()){
+	LayoutSpec row;
+	row.y = Px(y);
+	row.w = h.content ? Content() : Percent(100);
+	row.h = h;
+	return ui.add(form, row);
 }
 
 int main(){
+	// Built by `make pack`; without it every asset is read from its own file
+	if(SDL_GetPathInfo("res/assets.zpk", nullptr)){
+		zpack::mount("res/assets.zpk");
+	}
 	loadFonts();
 	app.updateWinSize();
 	app.startTextInput();
@@ -126,52 +84,92 @@ int main(){
 	setLayout(layout);
 
 	zbj textinForm(app.getRenderer());
+	textinForm.setCached(true);
 	setTextinForm(textinForm);
 
 	zbj usnm(app.getRenderer());
+	usnm.setCached(true);
 	setTitlePH(usnm);
 
-	zbj phusnm(app.getRenderer());
-	Bound busnm = {(int)(app.getWinSize().w * 0.7), app.getWinSize().h / 3 + 130, (int)(app.getWinSize().w * 0.275), 50};
-	setPH(phusnm, busnm, 0);
-
-	zbj phpass(app.getRenderer());
-	Bound bpass = {(int)(app.getWinSize().w * 0.7), app.getWinSize().h / 3 + 230, (int)(app.getWinSize().w * 0.275), 50};
-	setPH(phpass, bpass, 0);
-
-	vector<pair<Bound, pair<bool, string>>> idPH = {{busnm, {0, ""}}, {bpass, {0, ""}}};
-	zFuncs callUpdatePH = {
-		[&](){ setPH(phusnm, busnm, idPH.at(0).second.first, idPH.at(0).second.second); },
-		[&](){ setPH(phusnm, busnm, idPH.at(1).second.first, idPH.at(1).second.second); },
+	// Input fields: a keystroke only uploads glyphs not typed before and redraws the visible range
+	Font fieldFont = fonts.get(fLabel);
+	// Height sets the corner radius, the width comes from the layout
+	ztextfield phusnm(app.getRenderer(), fieldFont, {0, 0, 330, 50}, Hex("707070"), Hex("f1f1f1"), 0.5);
+	ztextfield phpass(app.getRenderer(), fieldFont, {0, 0, 330, 50}, Hex("707070"), Hex("f1f1f1"), 0.5);
+	phpass.setMask('*');
+
+	// Right third is the panel, the form column starts at 70% x and a third of the height
+	zlayout ui(app.getWinSize().w, app.getWinSize().h);
+	ui.bind(LAYOUT_ROOT, bg);
+
+	LayoutSpec panel;
+	panel.anchor = AnchorType::ANCHOR_TOP_RIGHT;
+	panel.w = Percent(100.0f / 3.0f);
+	ui.bind(ui.add(LAYOUT_ROOT, panel), layout);
+
+	LayoutSpec form;
+	form.x = Percent(70);
+	form.y = Percent(100.0f / 3.0f);
+	form.w = Percent(27.5f);
+	form.h = Px(280);
+	LayoutNode nForm = ui.add(LAYOUT_ROOT, form);
+	ui.bind(addFormRow(ui, nForm, 0), textinForm, 0);
+	ui.bind(addFormRow(ui, nForm, 50), textinForm, 1);
+	ui.bind(addFormRow(ui, nForm, 100), usnm, 0);
+	ui.bind(addFormRow(ui, nForm, 200), usnm, 1);
+	LayoutNode nUsnm = addFormRow(ui, nForm, 130, Px(50));
+	LayoutNode nPass = addFormRow(ui, nForm, 230, Px(50));
+	for(size_t i = 0; i < 2; i++){
+		ui.bind(nUsnm, phusnm.getObject(), i);
+		ui.bind(nPass, phpass.getObject(), i);
+	}
+	ui.update();
+
+	zscene scene(app.getRenderer());
+	scene.attach(bg);
+	scene.attach(layout);
+	scene.attach(textinForm);
+	scene.attach(usnm);
+	scene.attach(phusnm.getObject());
+	scene.attach(phpass.getObject());
+
+	bool showHUD = false;
+	auto handleEvent = [&](const Event& e){
+		if(e.type == SDL_EVENT_QUIT){
+			isRun = false;
+		}
+		if(e.type == SDL_EVENT_WINDOW_MAXIMIZED || e.type == SDL_EVENT_WINDOW_MINIMIZED || e.type == SDL_EVENT_WINDOW_RESTORED 
+		|| (e.type == SDL_EVENT_WINDOW_RESIZED && app.getWinSize().w >= 1200 && app.getWinSize().h >= 900)){
+			app.updateWinSize();
+			ui.setSize(app.getWinSize().w, app.getWinSize().h);
+		}
+		// F3 toggles the profiler overlay, F4 writes the recorded frames to disk
+		if(e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_F3){
+			showHUD = !showHUD;
+			app.setProfilerHUD(showHUD);
+			scene.invalidate();
+		}
+		if(e.type == SDL_EVENT_KEY_DOWN && e.key.key == SDLK_F4){
+			zprof::dumpCSV("zprof.csv");
+		}
+		phusnm.handle(e);
+		phpass.handle(e);
+		scene.handle(e);
 	};
 
 	while(isRun){
+		// Nothing to redraw: sleep until the next event (input, or a finished load) instead of polling
+		if(!scene.isDirty() && !ui.isDirty() && app.waitEvent(e)){
+			handleEvent(e);
+		}
 		while(SDL_PollEvent(&e)){
-			if(e.type == SDL_EVENT_QUIT){
-				isRun = false;
-			}
-			if(e.type == SDL_EVENT_WINDOW_MAXIMIZED || e.type == SDL_EVENT_WINDOW_MINIMIZED || e.type == SDL_EVENT_WINDOW_RESTORED 
-			|| (e.type == SDL_EVENT_WINDOW_RESIZED && app.getWinSize().w >= 1200 && app.getWinSize().h >= 900)){
-				app.updateWinSize();
-			}
-			if(e.type == SDL_EVENT_TEXT_INPUT){
-				for(auto& d : idPH){
-					uint32_t isFocusedPH = getClickState(e, d.first);
-					d.second.first = clickState2Bool(isFocusedPH);
-					if(d.second.first){ d.second.second += e.text.text; break;}
-				}
-			}
+			handleEvent(e);
 		}
-		callUpdatePH();
-		app.clearRender(Hex("000"));
-		bg.show();
-		layout.show();
-		textinForm.show();
-		usnm.show();
-		phusnm.show();
-		phpass.show();
-		app.present();
-		app.delay(1000);
+		// Arrived images mark their zbj dirty before render() checks the scene
+		app.pump();
+		// Only the nodes whose box changed are placed again
+		ui.update();
+		app.render(scene, Hex("000"));
 	}
 
 	app.stopTextInput();
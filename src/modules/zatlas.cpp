@@ -0,0 +1,156 @@
+#include "zatlas.h"
+#include "zprof.h"
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+
+static constexpr int PADDING = 1;  // transparent gap so linear filtering never bleeds between regions
+
+static std::unordered_map<Renderer, std::unique_ptr<zatlas>>& atlases() {
+	// Never destroyed: zmain drops its entry explicitly, possibly during static destruction
+	static auto* a = new std::unordered_map<Renderer, std::unique_ptr<zatlas>>();
+	return *a;
+}
+
+zatlas::zatlas(Renderer renderer, int pageSize, int maxRegion) : renderer(renderer), pageSize(pageSize), maxRegion(maxRegion) {}
+
+zatlas::~zatlas() {
+	clear();
+}
+
+zatlas& zatlas::get(Renderer renderer) {
+	auto& a = atlases();
+	auto it = a.find(renderer);
+	if (it != a.end()) return *it->second;
+	return *a.emplace(renderer, std::make_unique<zatlas>(renderer)).first->second;
+}
+
+void zatlas::drop(Renderer renderer) {
+	atlases().erase(renderer);
+}
+
+bool zatlas::newPage() {
+	Texture t = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, pageSize, pageSize);
+	if (!t) { std::cerr << "Error: Could not create atlas page! " << SDL_GetError() << std::endl; return false; }
+	zprof::countTexture();
+	SDL_SetTextureBlendMode(t, SDL_BLENDMODE_BLEND);
+	// Static textures start undefined; the padding between regions must read as transparent
+	std::vector<Uint32> zero(static_cast<size_t>(pageSize) * pageSize, 0);
+	SDL_UpdateTexture(t, nullptr, zero.data(), pageSize * 4);
+	pages.push_back({ t, { { 0, 0, pageSize } }, 0 });
+	return true;
+}
+
+// Height at which a w*h rect would rest if its left edge starts at skyline node `index`
+bool zatlas::fit(const Page& p, size_t index, int w, int h, int& y) const {
+	int x = p.skyline[index].x;
+	if (x + w > pageSize) return false;
+	int remaining = w;
+	y = p.skyline[index].y;
+	for (size_t i = index; remaining > 0; i++) {
+		if (i >= p.skyline.size()) return false;
+		y = std::max(y, p.skyline[i].y);
+		if (y + h > pageSize) return false;
+		remaining -= p.skyline[i].w;
+	}
+	return true;
+}
+
+bool zatlas::place(Page& p, int w, int h, Bound& out) {
+	size_t best = p.skyline.size();
+	int bestY = pageSize, bestW = pageSize;
+	for (size_t i = 0; i < p.skyline.size(); i++) {
+		int y;
+		if (!fit(p, i, w, h, y)) continue;
+		if (y + h < bestY || (y + h == bestY && p.skyline[i].w < bestW)) {
+			best = i;
+			bestY = y + h;
+			bestW = p.skyline[i].w;
+		}
+	}
+	if (best == p.skyline.size()) return false;
+
+	Skyline node = { p.skyline[best].x, bestY, w };
+	out = { node.x, bestY - h, w, h };
+	p.skyline.insert(p.skyline.begin() + best, node);
+
+	// Trim the nodes now covered by the new one
+	for (size_t i = best + 1; i < p.skyline.size(); ) {
+		Skyline& prev = p.skyline[i - 1];
+		Skyline& cur = p.skyline[i];
+		if (cur.x >= prev.x + prev.w) break;
+		int shrink = prev.x + prev.w - cur.x;
+		cur.x += shrink;
+		cur.w -= shrink;
+		if (cur.w <= 0) { p.skyline.erase(p.skyline.begin() + i); continue; }
+		break;
+	}
+	// Merge neighbours of equal height
+	for (size_t i = 0; i + 1 < p.skyline.size(); ) {
+		if (p.skyline[i].y == p.skyline[i + 1].y) {
+			p.skyline[i].w += p.skyline[i + 1].w;
+			p.skyline.erase(p.skyline.begin() + i + 1);
+		} else {
+			i++;
+		}
+	}
+	return true;
+}
+
+bool zatlas::pack(Surface s, AtlasRegion& out) {
+	if (!s || s->w <= 0 || s->h <= 0) return false;
+	ZPROF_SCOPE(ProfSection::UPLOAD);
+	if (s->w > maxRegion || s->h > maxRegion) return false;
+	int w = s->w + PADDING, h = s->h + PADDING;
+
+	Bound r;
+	Page* target = nullptr;
+	for (auto& p : pages) {
+		if (place(p, w, h, r)) { target = &p; break; }
+	}
+	if (!target) {
+		if (!newPage()) return false;
+		target = &pages.back();
+		if (!place(*target, w, h, r)) return false;
+	}
+	r.w -= PADDING;
+	r.h -= PADDING;
+
+	Surface rgba = s;
+	if (s->format != SDL_PIXELFORMAT_RGBA32) {
+		rgba = SDL_ConvertSurface(s, SDL_PIXELFORMAT_RGBA32);
+		if (!rgba) { std::cerr << "Error: Could not convert surface for atlas! " << SDL_GetError() << std::endl; return false; }
+	}
+	bool ok = SDL_UpdateTexture(target->texture, &r, rgba->pixels, rgba->pitch);
+	if (rgba != s) SDL_DestroySurface(rgba);
+	if (!ok) { std::cerr << "Error: Could not upload atlas region! " << SDL_GetError() << std::endl; return false; }
+
+	target->live++;
+	out.page = target->texture;
+	out.src = { static_cast<float>(r.x), static_cast<float>(r.y), static_cast<float>(r.w), static_cast<float>(r.h) };
+	return true;
+}
+
+bool zatlas::release(Texture page) {
+	for (auto& p : pages) {
+		if (p.texture != page) continue;
+		if (p.live > 0) p.live--;
+		// Skyline packing cannot free single regions; an empty page is simply reset
+		if (p.live == 0) p.skyline = { { 0, 0, pageSize } };
+		return true;
+	}
+	return false;
+}
+
+void zatlas::clear() {
+	for (auto& p : pages) { SDL_DestroyTexture(p.texture); }
+	pages.clear();
+}
+
+size_t zatlas::getPageCount() const {
+	return pages.size();
+}
+
+int zatlas::getMaxRegion() const {
+	return maxRegion;
+}
@@ -0,0 +1,161 @@
+#include "zbatch.h"
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+
+static std::unordered_map<Renderer, std::unique_ptr<zbatch>>& batches() {
+	// Never destroyed: zmain drops its entry explicitly, possibly during static destruction
+	static auto* b = new std::unordered_map<Renderer, std::unique_ptr<zbatch>>();
+	return *b;
+}
+
+zbatch::zbatch(Renderer renderer) : renderer(renderer), texture(nullptr), texW(1.0f), texH(1.0f), enabled(true), drawCalls(0), lastDrawCalls(0) {
+	vertices.reserve(4 * 256);
+	indices.reserve(6 * 256);
+}
+
+zbatch& zbatch::get(Renderer renderer) {
+	auto& b = batches();
+	auto it = b.find(renderer);
+	if (it != b.end()) return *it->second;
+	return *b.emplace(renderer, std::make_unique<zbatch>(renderer)).first->second;
+}
+
+void zbatch::drop(Renderer renderer) {
+	batches().erase(renderer);
+}
+
+// Starts a new run when the texture changes
+void zbatch::begin(Texture t) {
+	if (!vertices.empty() && t != texture) flush();
+	if (vertices.empty()) {
+		texture = t;
+		if (!t || !SDL_GetTextureSize(t, &texW, &texH)) { texW = 1.0f; texH = 1.0f; }
+	}
+}
+
+void zbatch::push(Texture t, const FBound* src, const FBound& dst) {
+	if (!enabled) {
+		SDL_RenderTexture(renderer, t, src, &dst);
+		drawCalls++;
+		return;
+	}
+	begin(t);
+
+	float u0 = 0.0f, v0 = 0.0f, u1 = 1.0f, v1 = 1.0f;
+	if (src) {
+		u0 = src->x / texW;
+		v0 = src->y / texH;
+		u1 = (src->x + src->w) / texW;
+		v1 = (src->y + src->h) / texH;
+	}
+	const SDL_FColor white = { 1.0f, 1.0f, 1.0f, 1.0f };
+	int base = static_cast<int>(vertices.size());
+	vertices.push_back({ { dst.x, dst.y }, white, { u0, v0 } });
+	vertices.push_back({ { dst.x + dst.w, dst.y }, white, { u1, v0 } });
+	vertices.push_back({ { dst.x + dst.w, dst.y + dst.h }, white, { u1, v1 } });
+	vertices.push_back({ { dst.x, dst.y + dst.h }, white, { u0, v1 } });
+	indices.insert(indices.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+}
+
+// Nine-slice quad: corners keep `inset` pixels of the source, edges and centre stretch to dst
+void zbatch::pushNine(Texture t, const FBound* src, float inset, const FBound& dst) {
+	if (!enabled) {
+		SDL_RenderTexture9Grid(renderer, t, src, inset, inset, inset, inset, 1.0f, &dst);
+		drawCalls++;
+		return;
+	}
+	begin(t);
+
+	FBound s = src ? *src : FBound{ 0.0f, 0.0f, texW, texH };
+	// A destination smaller than both corners shrinks the corners instead of overlapping them
+	float ix = std::min(inset, dst.w * 0.5f), iy = std::min(inset, dst.h * 0.5f);
+	float xs[4] = { dst.x, dst.x + ix, dst.x + dst.w - ix, dst.x + dst.w };
+	float ys[4] = { dst.y, dst.y + iy, dst.y + dst.h - iy, dst.y + dst.h };
+	float us[4] = { s.x / texW, (s.x + inset) / texW, (s.x + s.w - inset) / texW, (s.x + s.w) / texW };
+	float vs[4] = { s.y / texH, (s.y + inset) / texH, (s.y + s.h - inset) / texH, (s.y + s.h) / texH };
+
+	const SDL_FColor white = { 1.0f, 1.0f, 1.0f, 1.0f };
+	int base = static_cast<int>(vertices.size());
+	for (int row = 0; row < 4; row++) {
+		for (int col = 0; col < 4; col++) {
+			vertices.push_back({ { xs[col], ys[row] }, white, { us[col], vs[row] } });
+		}
+	}
+	for (int row = 0; row < 3; row++) {
+		for (int col = 0; col < 3; col++) {
+			int i = base + row * 4 + col;
+			indices.insert(indices.end(), { i, i + 1, i + 5, i, i + 5, i + 4 });
+		}
+	}
+}
+
+static SDL_FColor toFColor(Color c) {
+	return { c.r / 255.0f, c.g / 255.0f, c.b / 255.0f, c.a / 255.0f };
+}
+
+// Untextured solid rectangle
+void zbatch::pushRect(const FBound& dst, Color color) {
+	if (!enabled) {
+		SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+		SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+		SDL_RenderFillRect(renderer, &dst);
+		drawCalls++;
+		return;
+	}
+	begin(nullptr);
+	SDL_FColor c = toFColor(color);
+	int base = static_cast<int>(vertices.size());
+	vertices.push_back({ { dst.x, dst.y }, c, { 0.0f, 0.0f } });
+	vertices.push_back({ { dst.x + dst.w, dst.y }, c, { 0.0f, 0.0f } });
+	vertices.push_back({ { dst.x + dst.w, dst.y + dst.h }, c, { 0.0f, 0.0f } });
+	vertices.push_back({ { dst.x, dst.y + dst.h }, c, { 0.0f, 0.0f } });
+	indices.insert(indices.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+}
+
+// Untextured convex outline given relative to dst's origin, drawn as a fan around dst's centre
+void zbatch::pushFan(const std::vector<FPoint>& ring, const FBound& dst, Color color) {
+	if (ring.size() < 3) return;
+	if (!enabled) flush();
+	begin(nullptr);
+	SDL_FColor c = toFColor(color);
+	int base = static_cast<int>(vertices.size());
+	int n = static_cast<int>(ring.size());
+	vertices.push_back({ { dst.x + dst.w * 0.5f, dst.y + dst.h * 0.5f }, c, { 0.0f, 0.0f } });
+	for (const FPoint& p : ring) vertices.push_back({ { dst.x + p.x, dst.y + p.y }, c, { 0.0f, 0.0f } });
+	for (int i = 1; i <= n; i++) {
+		indices.insert(indices.end(), { base, base + i, base + (i % n) + 1 });
+	}
+	if (!enabled) flush();
+}
+
+void zbatch::flush() {
+	if (vertices.empty()) return;
+	if (!texture) SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+	if (!SDL_RenderGeometry(renderer, texture, vertices.data(), static_cast<int>(vertices.size()), indices.data(), static_cast<int>(indices.size()))) {
+		std::cerr << "Error: Could not render batch! " << SDL_GetError() << std::endl;
+	}
+	drawCalls++;
+	vertices.clear();
+	indices.clear();
+	texture = nullptr;
+}
+
+void zbatch::endFrame() {
+	flush();
+	lastDrawCalls = drawCalls;
+	drawCalls = 0;
+}
+
+void zbatch::setEnabled(bool enable) {
+	flush();
+	enabled = enable;
+}
+
+size_t zbatch::getDrawCalls() const {
+	return lastDrawCalls;
+}
+
+size_t zbatch::getPendingDrawCalls() const {
+	return drawCalls;
+}
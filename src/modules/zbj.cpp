@@ -1,9 +1,24 @@
 #include "zbj.h"
+#include "ztexcache.h"
+#include "zatlas.h"
+#include "zbatch.h"
+#include "zraster.h"
+#include "zprof.h"
+#include "ztextengine.h"
+#include "zloader.h"
+#include "zpack.h"
+#include "ztexbudget.h"
+#include "zhit.h"
+#include <algorithm>
 
 bool zbj::drawLine() {
-	if (textures[ID]) { std::cerr << "Error: Could not draw new line - clear textures first!" << std::endl; return false; }
+	ZPROF_SCOPE(ProfSection::DRAW);
+	if (isDrawn(ID)) { std::cerr << "Error: Could not draw new line - clear textures first!" << std::endl; return false; }
+	if (lazy) return defer(RecipeKind::LINE);
 	Texture t = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, bounds[ID].origin.w, bounds[ID].origin.h);
 	if (!t) { std::cerr << "Error: Could not create texture! " << SDL_GetError() << std::endl; return false; }
+	zprof::countTexture();
+	zbatch::get(renderer).flush();  // pending quads belong to the current target
 	Texture oldTarget = SDL_GetRenderTarget(renderer);
 	SDL_SetRenderTarget(renderer, t);
 	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
@@ -13,140 +28,389 @@ bool zbj::drawLine() {
 	SDL_RenderLine(renderer, 0, 0, bounds[ID].origin.w, bounds[ID].origin.h);
 	SDL_SetRenderTarget(renderer, oldTarget);
 	textures[ID] = t;
+	items[ID].src = {0, 0, 0, 0};
+	items[ID].slice = 0.0f;
+	record(RecipeKind::LINE);
+	track(ID, static_cast<size_t>(bounds[ID].origin.w) * bounds[ID].origin.h * 4);
+	touch();
 	return true;
 }
 
 bool zbj::draw(float radiusScale) {
-	if (textures[ID]) { std::cerr << "Error: Could not draw new rectangle - clear textures first!" << std::endl; return false; }
+	ZPROF_SCOPE(ProfSection::DRAW);
+	if (isDrawn(ID)) { std::cerr << "Error: Could not draw new rectangle - clear textures first!" << std::endl; return false; }
 	if (radiusScale < 0.0f || radiusScale > 1.0f) { std::cerr << "Error: Radius scale value must be between 0.0 and 1.0" << std::endl; return false; }
+	if (lazy) return defer(RecipeKind::SHAPE, radiusScale);
 	if (radiusScale == 0.0f) {
 		Surface s = SDL_CreateSurface(bounds[ID].origin.w, bounds[ID].origin.h, SDL_PIXELFORMAT_RGBA32);
 		if (!s) { std::cerr << "Error: Could not create surface! " << SDL_GetError() << std::endl; return false; }   
 		Uint32 pixel = SDL_MapRGBA(SDL_GetPixelFormatDetails(SDL_PIXELFORMAT_RGBA32), nullptr, color.r, color.g, color.b, color.a);
 		SDL_FillSurfaceRect(s, nullptr, pixel);
-		Texture t = SDL_CreateTextureFromSurface(renderer, s);
+		bool ok = commit(s);
 		SDL_DestroySurface(s);
-		if (!t) { std::cerr << "Error: Could not create texture! " << SDL_GetError() << std::endl; return false; }
-		textures[ID] = t;
+		if (!ok) { std::cerr << "Error: Could not create texture! " << SDL_GetError() << std::endl; return false; }
+		record(RecipeKind::SHAPE, radiusScale);
 		return true;
 	}
 	float minDimension = std::min(bounds[ID].origin.w, bounds[ID].origin.h);
 	float radius = minDimension * radiusScale * 0.5f;
-	Surface s = SDL_CreateSurface(bounds[ID].origin.w, bounds[ID].origin.h, SDL_PIXELFORMAT_RGBA32);
+	// Only the four corners plus a one pixel stretchable cross are rasterized (nine-slice),
+	// so later setBound() calls resize the box without touching the texture
+	int inset = static_cast<int>(std::ceil(radius));
+	int side = 2 * inset + 1;
+	Surface s = SDL_CreateSurface(side, side, SDL_PIXELFORMAT_RGBA32);
 	if (!s) { std::cerr << "Error: Could not create surface! " << SDL_GetError() << std::endl; return false; }
-	SDL_FillSurfaceRect(s, nullptr, SDL_MapRGBA(SDL_GetPixelFormatDetails(SDL_PIXELFORMAT_RGBA32), nullptr, 0, 0, 0, 0));        
 	if (!SDL_LockSurface(s)) { std::cerr << "Error: Failed to lock surface! " << SDL_GetError() << std::endl; SDL_DestroySurface(s); return false; }
-	Uint32 pixel = SDL_MapRGBA(SDL_GetPixelFormatDetails(SDL_PIXELFORMAT_RGBA32), nullptr, color.r, color.g, color.b, color.a);
-	SDL_Rect inner1 = { static_cast<int>(radius), 0, bounds[ID].origin.w - static_cast<int>(2 * radius), bounds[ID].origin.h };
-	SDL_Rect inner2 = { 0, static_cast<int>(radius), bounds[ID].origin.w, bounds[ID].origin.h - static_cast<int>(2 * radius) };
-	SDL_FillSurfaceRect(s, &inner1, pixel);
-	SDL_FillSurfaceRect(s, &inner2, pixel);
-	auto drawCorner = [&](SDL_FPoint center, float startAngle) {
-		for (float angle = 0; angle <= 90.0f; angle += 0.5f) {
-			float rad = (startAngle + angle) * (M_PI / 180.0f);
-			for (float r = 0; r <= radius; r += 0.5f) {
-				int x = static_cast<int>(center.x + r * cosf(rad));
-				int y = static_cast<int>(center.y + r * sinf(rad));
-				if (x >= 0 && y >= 0 && x < s->w && y < s->h) {
-					static_cast<Uint32*>(s->pixels)[y * s->w + x] = pixel;
-				}
-			}
-		}
-	};
-	drawCorner({ radius, radius }, 180.0f);
-	drawCorner({ static_cast<float>(bounds[ID].origin.w) - radius, radius }, 270.0f);
-	drawCorner({ static_cast<float>(bounds[ID].origin.w) - radius, static_cast<float>(bounds[ID].origin.h) - radius }, 0.0f);
-	drawCorner({ radius, static_cast<float>(bounds[ID].origin.h) - radius }, 90.0f);
+	zraster::roundRect(s->pixels, s->pitch, s->w, s->h, radius, color);
 	SDL_UnlockSurface(s);
-	Texture t = SDL_CreateTextureFromSurface(renderer, s);
+	bool ok = commit(s);
 	SDL_DestroySurface(s);
-	if (!t) { std::cerr << "Error: Could not create rounded texture! " << SDL_GetError() << std::endl; return false; }
-	textures[ID] = t;
+	if (!ok) { std::cerr << "Error: Could not create rounded texture! " << SDL_GetError() << std::endl; return false; }
+	items[ID].slice = static_cast<float>(inset);
+	record(RecipeKind::SHAPE, radiusScale);
 	return true;
 }
 
-bool zbj::draw(const Font font, const char* text, Point pos) {
-	if (textures[ID]) { std::cerr << "Error: Could not draw new text - clear textures first!" << std::endl; return false; }
+// Same shapes as draw(radiusScale) without any surface or texture: the item keeps its color and
+// corner radius and is drawn as a rect or a cached triangle fan, so moving or resizing is free
+bool zbj::fill(float radiusScale) {
+	ZPROF_SCOPE(ProfSection::DRAW);
+	if (isDrawn(ID)) { std::cerr << "Error: Could not fill new shape - clear textures first!" << std::endl; return false; }
+	if (radiusScale < 0.0f || radiusScale > 1.0f) { std::cerr << "Error: Radius scale value must be between 0.0 and 1.0" << std::endl; return false; }
+	Item& item = items[ID];
+	item.prim = true;
+	item.fill = color;
+	item.radius = std::min(bounds[ID].origin.w, bounds[ID].origin.h) * radiusScale * 0.5f;
+	item.mesh.clear();
+	item.meshW = item.meshH = -1;
+	touch();
+	return true;
+}
+
+bool zbj::draw(const Font font, const char* text, Point pos, int wrapWidth) {
+	ZPROF_SCOPE(ProfSection::TEXT);
+	if (isDrawn(ID)) { std::cerr << "Error: Could not draw new text - clear textures first!" << std::endl; return false; }
 	if (!font || !text) { std::cerr << "Error: Invalid font or text!\n"; return false; }
 	// Fixed: Added check for text length
 	size_t textLength = strlen(text);
 	if (textLength == 0) { std::cerr << "Error: Empty text string!\n"; return false; }
-	Surface s = TTF_RenderText_Blended(font, text, textLength, color);
+	if (lazy) {
+		// Measuring shapes the string but allocates no surface, the bound is known before show()
+		int w = 0, h = 0;
+		bool measured = wrapWidth > 0 ? TTF_GetStringSizeWrapped(font, text, textLength, wrapWidth, &w, &h) : TTF_GetStringSize(font, text, textLength, &w, &h);
+		if (!measured) { std::cerr << "Error: Could not measure text! " << SDL_GetError() << std::endl; return false; }
+		bounds[ID].origin = {pos.x, pos.y, w, h};
+		return defer(RecipeKind::TEXT, 0.0f, font, text, wrapWidth);
+	}
+	if (!packed) {
+		// Memoized per (font, string, color, wrap): switching back to a seen string is a lookup
+		int w = 0, h = 0;
+		Texture t = ztexcache::get(renderer).acquireText(font, text, color, wrapWidth, w, h);
+		if (!t) return false;
+		textures[ID] = t;
+		items[ID].src = {0, 0, 0, 0};
+		items[ID].slice = 0.0f;
+		bounds[ID].origin = {pos.x, pos.y, w, h};
+		record(RecipeKind::TEXT, 0.0f, font, text, wrapWidth);
+		track(ID, static_cast<size_t>(w) * h * 4, t);
+		touch();
+		return true;
+	}
+	Surface s = wrapWidth > 0 ? TTF_RenderText_Blended_Wrapped(font, text, textLength, color, wrapWidth) : TTF_RenderText_Blended(font, text, textLength, color);
 	if (!s) { std::cerr << "Error: Could not render text! " << SDL_GetError() << std::endl;  return false; }
-	Texture t = SDL_CreateTextureFromSurface(renderer, s);
-	if (!t) { std::cerr << "Error: Could not create texture from text! " << SDL_GetError() << std::endl; SDL_DestroySurface(s); return false; }
+	if (!commit(s)) { std::cerr << "Error: Could not create texture from text! " << SDL_GetError() << std::endl; SDL_DestroySurface(s); return false; }
 	bounds[ID].origin = {pos.x, pos.y, s->w, s->h};
-	textures[ID] = t;
 	SDL_DestroySurface(s);
+	record(RecipeKind::TEXT, 0.0f, font, text, wrapWidth);
+	return true;
+}
+
+// Glyphs come from the renderer's text engine atlas, so the string is never rasterized as a whole
+bool zbj::drawText(const Font font, const char* text, Point pos) {
+	ZPROF_SCOPE(ProfSection::TEXT);
+	if (isDrawn(ID)) { std::cerr << "Error: Could not draw new text - clear textures first!" << std::endl; return false; }
+	if (!font || !text) { std::cerr << "Error: Invalid font or text!\n"; return false; }
+	Text t = ztextengine::get(renderer).create(font, text, color);
+	if (!t) return false;
+	int w = 0, h = 0;
+	TTF_GetTextSize(t, &w, &h);
+	items[ID].text = t;
+	bounds[ID].origin = {pos.x, pos.y, w, h};
+	touch();
+	return true;
+}
+
+// Replaces the string of the active text item; only glyphs not seen before get uploaded
+bool zbj::setText(const char* text) {
+	ZPROF_SCOPE(ProfSection::TEXT);
+	if (ID >= items.size() || !items[ID].text) { std::cerr << "Error: Active item is not a text item!" << std::endl; return false; }
+	if (!text) { std::cerr << "Error: Invalid text!\n"; return false; }
+	Text t = items[ID].text;
+	if (!TTF_SetTextString(t, text, 0)) { std::cerr << "Error: Could not set text! " << SDL_GetError() << std::endl; return false; }
+	int w = 0, h = 0;
+	TTF_GetTextSize(t, &w, &h);
+	bounds[ID].origin.w = w;
+	bounds[ID].origin.h = h;
+	touch();
+	return true;
+}
+
+// The active item's content comes from painter at show() time; call markDirty() when it changes
+bool zbj::drawWith(Painter painter) {
+	if (isDrawn(ID)) { std::cerr << "Error: Could not set painter - clear textures first!" << std::endl; return false; }
+	if (!painter) { std::cerr << "Error: Invalid painter!\n"; return false; }
+	items[ID].painter = std::move(painter);
+	touch();
 	return true;
 }
 
 bool zbj::draw(const char* path) {
-	if (textures[ID]) { std::cerr << "Error: Could not draw new image - clear textures first!" << std::endl; return false; }
+	ZPROF_SCOPE(ProfSection::DRAW);
+	if (isDrawn(ID)) { std::cerr << "Error: Could not draw new image - clear textures first!" << std::endl; return false; }
 	if (!path) {std::cerr << "Error: Invalid image path!\n"; return false; }
-	Surface s = IMG_Load(path);
-	if (!s) { std::cerr << "Error: Could not load image! " << SDL_GetError() << std::endl; return false; }
-	Texture t = SDL_CreateTextureFromSurface(renderer, s);
-	if (!t) { 
-		std::cerr << "Error: Could not create texture from image! " << SDL_GetError() << std::endl; 
-		SDL_DestroySurface(s);  // Fixed: Added missing surface cleanup
-		return false; 
-	}
-	bounds[ID].origin.w = s->w;
-	bounds[ID].origin.h = s->h;
-	SDL_DestroySurface(s);
+	// The item takes the image size like below: a packed one now, a file once show() decodes it,
+	// the bound set until then only decides whether it is in view. An empty bound loads now.
+	if (lazy && !SDL_RectEmpty(&bounds[ID].origin)) {
+		PackAsset asset;
+		if (zpack::find(path, asset)) {
+			bounds[ID].origin.w = static_cast<int>(asset.entry->w);
+			bounds[ID].origin.h = static_cast<int>(asset.entry->h);
+		}
+		return defer(RecipeKind::IMAGE, 0.0f, nullptr, path);
+	}
+	// Images are shared per renderer: N items drawing the same file hold one texture
+	FBound src;
+	bool atlas = false;
+	Texture t = ztexcache::get(renderer).acquire(path, src, packed, nullptr, &atlas);
+	if (!t) return false;
+	bounds[ID].origin.w = static_cast<int>(src.w);
+	bounds[ID].origin.h = static_cast<int>(src.h);
 	textures[ID] = t;
+	items[ID].src = src;
+	items[ID].slice = 0.0f;
+	record(RecipeKind::IMAGE, 0.0f, nullptr, path);
+	// Atlas pages are shared by unrelated images, only a texture of its own is charged
+	if (!atlas) track(ID, static_cast<size_t>(src.w * src.h) * 4, t);
+	touch();
 	return true;
 }
 
-zbj::zbj(Renderer renderer) : renderer(renderer), ID(0) {
-	bounds.resize(1);
-	textures.resize(1);  // Fixed: Added missing texture resize
-	anchor.resize(1);    // Fixed: Added missing anchor resize
-	bounds[ID].origin = {0, 0, 0, 0};
-	textures[ID] = nullptr;  // Fixed: Initialize texture to nullptr
-	anchor[ID] = AnchorType::ANCHOR_TOP_LEFT;
+// Same as draw(path), but the file is decoded on a zloader worker. Until it arrives the item is a
+// placeholder filled with the object color; a non-empty bound is kept, an empty one takes the image size.
+bool zbj::drawAsync(const char* path) {
+	ZPROF_SCOPE(ProfSection::DRAW);
+	if (isDrawn(ID)) { std::cerr << "Error: Could not draw new image - clear textures first!" << std::endl; return false; }
+	if (!path) {std::cerr << "Error: Invalid image path!\n"; return false; }
+	FBound src;
+	bool atlas = false;
+	Texture t = ztexcache::get(renderer).find(path, src, packed, &atlas);
+	// Packed images are decoded already, the upload alone does not need a worker
+	PackAsset asset;
+	if (!t && zpack::find(path, asset)) t = ztexcache::get(renderer).acquire(path, src, packed, nullptr, &atlas);
+	if (t) {
+		if (SDL_RectEmpty(&bounds[ID].origin)) {
+			bounds[ID].origin.w = static_cast<int>(src.w);
+			bounds[ID].origin.h = static_cast<int>(src.h);
+		}
+		textures[ID] = t;
+		items[ID].src = src;
+		items[ID].slice = 0.0f;
+		record(RecipeKind::IMAGE, 0.0f, nullptr, path);
+		if (!atlas) track(ID, static_cast<size_t>(src.w * src.h) * 4, t);
+		touch();
+		return true;
+	}
+	Item& item = items[ID];
+	item.prim = true;
+	item.fill = color;
+	item.radius = 0.0f;
+	item.pending = path;
+	touch();
+	return zloader::loadSurface(path, this, [this, key = item.pending](Surface s) { resolve(key, s); });
+}
+
+// The zloader callback is shared by every item waiting on the same path, so it is only dropped
+// with the last of them
+void zbj::dropWaiter(size_t index) {
+	const std::string& path = items[index].pending;
+	for (size_t i = 0; i < items.size(); i++) {
+		if (i != index && items[i].pending == path) return;
+	}
+	zloader::cancel(this, path.c_str());
 }
 
-zbj::zbj(Bound bound, Color color, Renderer renderer) : color(color), renderer(renderer), ID(0) {
-	this->bounds.resize(1);
-	this->textures.resize(1);
-	this->anchor.resize(1);  // Fixed: Added missing anchor resize
+// zloader callback on the main thread: every item still waiting on path swaps its placeholder for the image
+void zbj::resolve(const std::string& path, Surface s) {
+	for (size_t i = 0; i < items.size(); i++) {
+		Item& item = items[i];
+		if (item.pending != path) continue;
+		item.pending.clear();
+		if (!s) continue;   // stays a placeholder, zloader reported the error
+		FBound src;
+		bool atlas = false;
+		Texture t = ztexcache::get(renderer).acquire(path.c_str(), src, packed, s, &atlas);
+		if (!t) continue;
+		if (SDL_RectEmpty(&bounds[i].origin)) {
+			bounds[i].origin.w = static_cast<int>(src.w);
+			bounds[i].origin.h = static_cast<int>(src.h);
+		}
+		item.prim = false;
+		textures[i] = t;
+		item.src = src;
+		item.slice = 0.0f;
+		item.recipe = { RecipeKind::IMAGE, color, 0.0f, nullptr, path, 0, packed, bounds[i].origin.w, bounds[i].origin.h };
+		if (!atlas) track(i, static_cast<size_t>(src.w * src.h) * 4, t);
+		touch();
+		if (hits) hits->update(*this, i);
+	}
+}
+
+zbj::zbj(Renderer renderer) : renderer(renderer), ID(0), packed(false), dirty(true), shown{ 0, 0, 0, 0 }, cached(false), layerDirty(true), layer(nullptr), layerExtent{ 0, 0, 0, 0 }, lazy(false), reshaped(false), head(NO_SLOT), tail(NO_SLOT), count(0), nextOrder(0), hits(nullptr) {
+	ID = allocSlot();
+}
+
+zbj::zbj(Bound bound, Color color, Renderer renderer) : color(color), renderer(renderer), ID(0), packed(false), dirty(true), shown{ 0, 0, 0, 0 }, cached(false), layerDirty(true), layer(nullptr), layerExtent{ 0, 0, 0, 0 }, lazy(false), reshaped(false), head(NO_SLOT), tail(NO_SLOT), count(0), nextOrder(0), hits(nullptr) {
+	ID = allocSlot();
 	this->bounds[ID].origin = bound;
-	this->textures[ID] = nullptr;
-	anchor[ID] = AnchorType::ANCHOR_TOP_LEFT;
 }
 
 zbj::~zbj() {
+	if (hits) hits->remove(*this);
+	// Also callbacks of items already removed: a queued resolve() must never reach a dead object
+	zloader::cancel(this);
 	clearItems();
+	destroyLayer();
 }
 
+// Uploads a rasterized surface for the active item, into the atlas when packing is enabled
+bool zbj::commit(Surface s) {
+	AtlasRegion region;
+	if (packed && zatlas::get(renderer).pack(s, region)) {
+		textures[ID] = region.page;
+		items[ID].src = region.src;
+		items[ID].slice = 0.0f;
+		touch();
+		return true;
+	}
+	Texture t;
+	{
+		ZPROF_SCOPE(ProfSection::UPLOAD);
+		t = SDL_CreateTextureFromSurface(renderer, s);
+	}
+	if (!t) return false;
+	zprof::countTexture();
+	track(ID, static_cast<size_t>(s->w) * s->h * 4);
+	textures[ID] = t;
+	items[ID].src = {0, 0, 0, 0};
+	items[ID].slice = 0.0f;
+	touch();
+	return true;
+}
+
+void zbj::releaseText(size_t index) {
+	if (!items[index].text) return;
+	TTF_DestroyText(items[index].text);
+	items[index].text = nullptr;
+}
+
+void zbj::releaseTexture(size_t index) {
+	Texture t = textures[index];
+	Item& item = items[index];
+	bool tracked = item.ticket != 0;
+	if (tracked) {
+		ztexbudget::get(renderer).remove(item.ticket);
+		item.ticket = 0;
+	}
+	// An evicted texture has to free memory, so cache entries go once nobody else holds them
+	if (ztexcache::get(renderer).release(t, item.src, tracked && item.evicted)) return;
+	if (zatlas::get(renderer).release(t)) return;
+	SDL_DestroyTexture(t);
+}
+
+// Every slot is freed but kept, so handles taken before stay invalid and the next addItem() is ID 0
 bool zbj::clearItems() {
-	for(auto& t : textures) {
-		if (t) { SDL_DestroyTexture(t); t = nullptr; }  // Fixed: Set to nullptr after destroying
-	} 
-	textures.clear();
-	bounds.clear();
-	anchor.clear();
+	// One cancel for every pending item, instead of freeSlot() looking for shared paths each time
+	zloader::cancel(this);
+	for (Item& item : items) item.pending.clear();
+	while (tail != NO_SLOT) freeSlot(tail);
 	ID = 0;  // Fixed: Reset ID to 0
+	touch();
 	return true;
 }
 
+// Rounded outline as a closed ring of points; corners get more segments as they grow
+static void buildRoundRing(std::vector<FPoint>& ring, float w, float h, float r) {
+	ring.clear();
+	int segments = std::clamp(static_cast<int>(r / 2.0f), 3, 24);
+	FPoint centers[4] = { { r, r }, { w - r, r }, { w - r, h - r }, { r, h - r } };
+	for (int corner = 0; corner < 4; corner++) {
+		float start = (180.0f + 90.0f * corner) * static_cast<float>(M_PI / 180.0);
+		for (int i = 0; i <= segments; i++) {
+			float a = start + (static_cast<float>(M_PI) * 0.5f) * i / segments;
+			ring.push_back({ centers[corner].x + r * cosf(a), centers[corner].y + r * sinf(a) });
+		}
+	}
+}
+
+// Whether a quad at r would touch the current target; items outside it are not rasterized yet
+static bool inView(Renderer renderer, const FBound& r) {
+	Bound vp;
+	if (!SDL_GetRenderViewport(renderer, &vp)) return true;
+	FBound view = { 0.0f, 0.0f, static_cast<float>(vp.w), static_cast<float>(vp.h) };
+	return SDL_HasRectIntersectionFloat(&r, &view);
+}
+
+// Pushes item `index` at its anchored position; the anchor must already be resolved
+void zbj::submit(size_t index, zbatch& batch, FPoint offset) {
+	FBound fRect = { 
+		static_cast<float>(bounds[index].current.x) + offset.x, 
+		static_cast<float>(bounds[index].current.y) + offset.y, 
+		static_cast<float>(bounds[index].origin.w), 
+		static_cast<float>(bounds[index].origin.h) };
+	if (items[index].evicted || items[index].deferred) {
+		if (!inView(renderer, fRect) || !regenerate(index)) return;
+		// A deferred image has its decoded size now, placed again by its anchor
+		Bound b = getRealBound(index);
+		fRect = { b.x + offset.x, b.y + offset.y, static_cast<float>(b.w), static_cast<float>(b.h) };
+	}
+	Item& item = items[index];
+	if (item.ticket) ztexbudget::get(renderer).touch(item.ticket);
+	if (item.painter) {
+		item.painter(batch, fRect);
+		return;
+	}
+	if (item.text) {
+		batch.flush();  // the text engine submits its own geometry, keep draw order
+		TTF_DrawRendererText(item.text, fRect.x, fRect.y);
+		return;
+	}
+	if (item.prim) {
+		if (item.radius <= 0.0f) { batch.pushRect(fRect, item.fill); return; }
+		if (item.meshW != bounds[index].origin.w || item.meshH != bounds[index].origin.h) {
+			float r = std::min(item.radius, std::min(fRect.w, fRect.h) * 0.5f);
+			buildRoundRing(item.mesh, fRect.w, fRect.h, r);
+			item.meshW = bounds[index].origin.w;
+			item.meshH = bounds[index].origin.h;
+		}
+		batch.pushFan(item.mesh, fRect, item.fill);
+		return;
+	}
+	const FBound& src = item.src;
+	if (item.slice > 0.0f) batch.pushNine(textures[index], src.w > 0 ? &src : nullptr, item.slice, fRect);
+	else batch.push(textures[index], src.w > 0 ? &src : nullptr, fRect);
+}
+
 bool zbj::show(size_t id) {
+	ZPROF_SCOPE(ProfSection::SHOW);
 	if (id >= textures.size()) { std::cerr << "Error: Invalid ID!" << std::endl; return false; }  // Fixed: Added index check
-	if (!textures[id]) { std::cerr << "Error: No texture to show for ID " << id << "!" << std::endl; return false; }
+	if (!isDrawn(id)) { std::cerr << "Error: No texture to show for ID " << id << "!" << std::endl; return false; }
 	
 	// Temporarily save the current ID
 	size_t tempID = ID;
 	ID = id;
 	
 	setAnchorPt(anchor[id]);
-	FBound fRect = { 
-		static_cast<float>(bounds[id].current.x), 
-		static_cast<float>(bounds[id].current.y), 
-		static_cast<float>(bounds[id].origin.w), 
-		static_cast<float>(bounds[id].origin.h) };
-	SDL_RenderTexture(renderer, textures[id], nullptr, &fRect);
+	submit(id, zbatch::get(renderer));
 	
 	// Restore the previous ID
 	ID = tempID;
@@ -154,129 +418,447 @@ bool zbj::show(size_t id) {
 }
 
 bool zbj::show() {
-	if (textures.empty()) { std::cerr << "Error: No textures to show!" << std::endl; return false; }  // Fixed: Check if vector is empty
+	ZPROF_SCOPE(ProfSection::SHOW);
+	if (count == 0) { std::cerr << "Error: No textures to show!" << std::endl; return false; }  // Fixed: Check if vector is empty
+	if (cached && (!layerDirty || buildLayer())) {
+		FBound dst;
+		SDL_RectToFRect(&layerExtent, &dst);
+		zbatch::get(renderer).push(layer, nullptr, dst);
+		return true;
+	}
 	bool success = true;
 	size_t tempID = ID;
 	SDL_SetHint(SDL_HINT_RENDER_LINE_METHOD, "1");
-	for(size_t i = 0; i < anchor.size(); i++) {
+	zbatch& batch = zbatch::get(renderer);
+	for(size_t i = head; i != NO_SLOT; i = slots[i].next) {
 		ID = i;  // Set current ID for anchor calculation
-		if (!textures[i]) { 
+		if (!isDrawn(i)) { 
 			std::cerr << "Warning: No texture to show for ID " << i << "!" << std::endl; 
 			continue;  // Fixed: Skip instead of failing entirely
 		}
 		setAnchorPt(anchor[i]);
-		FBound fRect = { 
-			static_cast<float>(bounds[i].current.x), 
-			static_cast<float>(bounds[i].current.y), 
-			static_cast<float>(bounds[i].origin.w), 
-			static_cast<float>(bounds[i].origin.h) };
-		SDL_RenderTexture(renderer, textures[i], nullptr, &fRect);
+		submit(i, batch);
 	}
 	ID = tempID;
 	return success;
 }
 
 void zbj::setBound(const Bound& newBound) { 
+	if (SDL_RectsEqual(&bounds[ID].origin, &newBound)) return;
 	bounds[ID].origin = newBound;
+	touch();
 }
 
 void zbj::setColor(const Color& newColor) { 
+	if (color.r == newColor.r && color.g == newColor.g && color.b == newColor.b && color.a == newColor.a) return;
 	color = newColor; 
+	touch();
 }
 
-void zbj::addItem() {
-	ID = bounds.size();
-	textures.resize(ID+1);
-	bounds.resize(ID+1);
-	anchor.resize(ID+1);
-	bounds[ID].origin = bounds[ID-1].origin;
-	bounds[ID].current = bounds[ID-1].current;
-	anchor[ID] = anchor[ID-1];
-	textures[ID] = nullptr;
+// Hands out a removed slot when there is one, else grows every slot array by one; the item is
+// blank and drawn last
+size_t zbj::allocSlot() {
+	size_t index;
+	if (!freeSlots.empty()) {
+		index = freeSlots.back();
+		freeSlots.pop_back();
+	} else {
+		index = slots.size();
+		slots.push_back({ 0, NO_SLOT, NO_SLOT, 0, false });
+		bounds.emplace_back();
+		textures.push_back(nullptr);
+		anchor.push_back(AnchorType::ANCHOR_TOP_LEFT);
+		items.emplace_back();
+	}
+	Slot& slot = slots[index];
+	slot.generation++;
+	slot.alive = true;
+	slot.prev = tail;
+	slot.next = NO_SLOT;
+	slot.order = nextOrder++;
+	if (tail != NO_SLOT) slots[tail].next = static_cast<Uint32>(index);
+	else head = static_cast<Uint32>(index);
+	tail = static_cast<Uint32>(index);
+	count++;
+	bounds[index] = Anchor{};
+	anchor[index] = AnchorType::ANCHOR_TOP_LEFT;
+	return index;
+}
+
+// Releases what the item holds and unlinks it; the slot waits in freeSlots for the next add
+void zbj::freeSlot(size_t index) {
+	if (!items[index].pending.empty()) dropWaiter(index);
+	if (textures[index]) releaseTexture(index);
+	releaseText(index);
+	textures[index] = nullptr;
+	items[index] = Item{};
+	Slot& slot = slots[index];
+	if (slot.prev != NO_SLOT) slots[slot.prev].next = slot.next;
+	else head = slot.next;
+	if (slot.next != NO_SLOT) slots[slot.next].prev = slot.prev;
+	else tail = slot.prev;
+	slot.prev = slot.next = NO_SLOT;
+	slot.alive = false;
+	count--;
+	freeSlots.push_back(static_cast<Uint32>(index));
+	if (hits) hits->update(*this, index);
+}
+
+// The new item starts with the bound and anchor of the last item and becomes the active one
+ItemHandle zbj::addItem() {
+	Uint32 last = tail;
+	ID = allocSlot();
+	if (last != NO_SLOT) {
+		bounds[ID] = bounds[last];
+		anchor[ID] = anchor[last];
+	}
+	touch();
+	return getHandle(ID);
+}
+
+// Same as n addItem() calls with one allocation at most; the last new item becomes active
+size_t zbj::addItems(size_t n, std::vector<ItemHandle>* handles) {
+	if (n == 0) return 0;
+	reserve(count + n);
+	if (handles) handles->reserve(handles->size() + n);
+	Uint32 last = tail;
+	for (size_t i = 0; i < n; i++) {
+		ID = allocSlot();
+		if (last != NO_SLOT) {
+			bounds[ID] = bounds[last];
+			anchor[ID] = anchor[last];
+		}
+		if (handles) handles->push_back(getHandle(ID));
+	}
+	touch();
+	return n;
 }
 
 bool zbj::removeItem(size_t index) {
-	if (index >= bounds.size()) {
+	if (!isAlive(index)) {
 		std::cerr << "Error: Invalid index for removal: " << index << std::endl;
 		return false;
 	}
-	
-	if (textures[index]) {
-		SDL_DestroyTexture(textures[index]);
-	}
-	
-	bounds.erase(bounds.begin() + index);
-	textures.erase(textures.begin() + index);
-	anchor.erase(anchor.begin() + index);
+	freeSlot(index);
+	touch();
 	
 	// Ensure ID remains valid
-	if (ID >= bounds.size()) {
-		ID = bounds.empty() ? 0 : bounds.size() - 1;
+	if (ID == index) {
+		ID = tail == NO_SLOT ? 0 : tail;
 	}
 	
 	return true;
 }
 
+bool zbj::removeItem(ItemHandle handle) {
+	if (!isValid(handle)) { std::cerr << "Error: Stale item handle " << handle.index << "!" << std::endl; return false; }
+	return removeItem(handle.index);
+}
+
+// Handles that are already stale are skipped; returns how many items were removed
+size_t zbj::removeItems(const std::vector<ItemHandle>& handles) {
+	size_t removed = 0;
+	for (const ItemHandle& h : handles) {
+		if (!isValid(h)) continue;
+		freeSlot(h.index);
+		removed++;
+	}
+	if (removed == 0) return 0;
+	touch();
+	if (!isAlive(ID)) ID = tail == NO_SLOT ? 0 : tail;
+	return removed;
+}
+
+// Capacity for n items, so a spawner adding them one by one never reallocates
+void zbj::reserve(size_t n) {
+	if (n <= slots.size()) return;
+	slots.reserve(n);
+	freeSlots.reserve(n);
+	bounds.reserve(n);
+	textures.reserve(n);
+	anchor.reserve(n);
+	items.reserve(n);
+}
+
+void zbj::markDirty() {
+	touch();
+}
+
+// Every visible change also invalidates the cached layer; changes are made to the active item,
+// so that is the one the hit index re-reads
+void zbj::touch() {
+	dirty = true;
+	layerDirty = true;
+	if (hits) hits->update(*this, ID);
+}
+
+// Set by zhit::add() and zhit::remove()
+void zbj::setHitIndex(zhit* index) {
+	hits = index;
+}
+
+// shared is the ztexcache texture the item holds a reference to, charged once for all its holders
+void zbj::track(size_t index, size_t bytes, Texture shared) {
+	items[index].ticket = ztexbudget::get(renderer).add(this, index, bytes, shared);
+}
+
+// Called by each draw call on success, with the parameters it would need to run again
+void zbj::record(RecipeKind kind, float radiusScale, const Font font, const char* source, int wrapWidth) {
+	items[ID].recipe = { kind, color, radiusScale, font, source, wrapWidth, packed, bounds[ID].origin.w, bounds[ID].origin.h };
+}
+
+// Called by ztexbudget after present: drops the texture, the item keeps its recipe and bound.
+// The ticket is dropped with the texture, so a slot reused since never matches it.
+void zbj::evict(size_t index, Uint64 ticket) {
+	if (index >= items.size() || items[index].ticket != ticket) return;
+	items[index].evicted = true;
+	releaseTexture(index);
+	textures[index] = nullptr;
+}
+
+// Lazy draw calls stop here: the item is drawn as far as isDrawn() and getExtent() are concerned
+bool zbj::defer(RecipeKind kind, float radiusScale, const Font font, const char* source, int wrapWidth) {
+	record(kind, radiusScale, font, source, wrapWidth);
+	items[ID].deferred = true;
+	touch();
+	return true;
+}
+
+// Draws an evicted item again with the color, packing and size it had; the result looks the
+// same as before, so neither the object nor its cached layer becomes dirty. A deferred item is
+// drawn for the first time, at the size its bound has now; a deferred image takes its decoded
+// size instead, which repaints the object once more.
+bool zbj::regenerate(size_t index) {
+	Recipe r = items[index].recipe;
+	Bound origin = bounds[index].origin;
+	bool wasEvicted = items[index].evicted;
+	if (!wasEvicted) {
+		r.w = origin.w;
+		r.h = origin.h;
+	}
+	Color savedColor = color;
+	bool savedPacked = packed, savedLazy = lazy, savedDirty = dirty, savedLayerDirty = layerDirty;
+	size_t savedID = ID;
+	zhit* savedHits = hits;     // the bound ends up as it was, the index has nothing to learn
+	hits = nullptr;
+	ID = index;
+	color = r.color;
+	packed = r.packed;
+	lazy = false;
+	bounds[index].origin.w = r.w;
+	bounds[index].origin.h = r.h;
+	items[index].evicted = false;
+	items[index].deferred = false;
+	bool ok = false;
+	switch (r.kind) {
+		case RecipeKind::SHAPE: ok = draw(r.radiusScale); break;
+		case RecipeKind::LINE:  ok = drawLine(); break;
+		case RecipeKind::TEXT:  ok = draw(r.font, r.source.c_str(), { origin.x, origin.y }, r.wrapWidth); break;
+		case RecipeKind::IMAGE: ok = draw(r.source.c_str()); break;
+		case RecipeKind::NONE:  break;
+	}
+	Bound drawn = bounds[index].origin;
+	bounds[index].origin = origin;
+	bool adopted = ok && r.kind == RecipeKind::IMAGE && !wasEvicted && (drawn.w != origin.w || drawn.h != origin.h);
+	if (adopted) {
+		bounds[index].origin.w = drawn.w;
+		bounds[index].origin.h = drawn.h;
+	}
+	ID = savedID;
+	color = savedColor;
+	packed = savedPacked;
+	lazy = savedLazy;
+	hits = savedHits;
+	if (adopted) {
+		// The damage of this frame was collected at the old size, so the next frame repaints
+		dirty = layerDirty = reshaped = true;
+		if (hits) hits->update(*this, index);
+	} else {
+		dirty = savedDirty;
+		layerDirty = savedLayerDirty;
+	}
+	if (ok && wasEvicted) ztexbudget::get(renderer).countRegeneration();
+	if (!ok) std::cerr << "Error: Could not rasterize item " << index << " from its recipe!" << std::endl;
+	return ok;
+}
+
+void zbj::setCached(bool enable) {
+	if (cached == enable) return;
+	cached = enable;
+	if (!cached) destroyLayer();
+	touch();
+}
+
+// Later draw calls only record what to draw; show() rasterizes items on screen the first time
+void zbj::setLazy(bool enable) {
+	lazy = enable;
+}
+
+void zbj::destroyLayer() {
+	if (layer) SDL_DestroyTexture(layer);
+	layer = nullptr;
+	layerExtent = { 0, 0, 0, 0 };
+}
+
+// Composites every drawn item into one target texture covering the object's extent
+bool zbj::buildLayer() {
+	Bound extent = getExtent();
+	if (SDL_RectEmpty(&extent)) { destroyLayer(); return false; }
+	if (layer && (layerExtent.w != extent.w || layerExtent.h != extent.h)) destroyLayer();
+	if (!layer) {
+		layer = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, extent.w, extent.h);
+		if (!layer) { std::cerr << "Error: Could not create layer texture! " << SDL_GetError() << std::endl; return false; }
+		zprof::countTexture();
+		// Items are blended onto a transparent target, which leaves premultiplied color behind
+		SDL_SetTextureBlendMode(layer, SDL_BLENDMODE_BLEND_PREMULTIPLIED);
+	}
+
+	zbatch& batch = zbatch::get(renderer);
+	batch.flush();  // pending quads belong to the current target
+	Texture oldTarget = SDL_GetRenderTarget(renderer);
+	SDL_SetRenderTarget(renderer, layer);
+	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+	SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+	SDL_RenderClear(renderer);
+	// Cleared first: an item that changes size while drawn below leaves the layer dirty
+	layerDirty = false;
+	size_t tempID = ID;
+	FPoint offset = { static_cast<float>(-extent.x), static_cast<float>(-extent.y) };
+	for (size_t i = head; i != NO_SLOT; i = slots[i].next) {
+		if (!isDrawn(i)) continue;
+		ID = i;
+		setAnchorPt(anchor[i]);
+		submit(i, batch, offset);
+	}
+	ID = tempID;
+	batch.flush();
+	SDL_SetRenderTarget(renderer, oldTarget);
+	layerExtent = extent;
+	return true;
+}
+
+void zbj::markClean() {
+	dirty = reshaped;
+	reshaped = false;
+	shown = getExtent();
+}
+
+void zbj::setPacked(bool enable) {
+	packed = enable;
+}
+
 void zbj::setActiveID(size_t newID) {
-	if (newID >= bounds.size()) {
+	if (!isAlive(newID)) {
 		std::cerr << "Warning: Trying to set invalid ID: " << newID << ". Using last valid ID." << std::endl;
-		ID = bounds.empty() ? 0 : bounds.size() - 1;
+		ID = tail == NO_SLOT ? 0 : tail;
 		return;
 	}
 	ID = newID;
 }
 
+bool zbj::setActive(ItemHandle handle) {
+	if (!isValid(handle)) { std::cerr << "Error: Stale item handle " << handle.index << "!" << std::endl; return false; }
+	ID = handle.index;
+	return true;
+}
+
+// Top-left corner of `origin` once `type` is applied to it
+static Point anchorPos(const Bound& origin, AnchorType type) {
+	switch(type) {
+		case AnchorType::ANCHOR_TOP_LEFT:  return { origin.x, origin.y };
+		case AnchorType::ANCHOR_TOP_MID:   return { origin.x - origin.w / 2, origin.y };
+		case AnchorType::ANCHOR_TOP_RIGHT: return { origin.x - origin.w, origin.y };
+		case AnchorType::ANCHOR_RIGHT_MID: return { origin.x - origin.w, origin.y - origin.h / 2 };
+		case AnchorType::ANCHOR_BOT_RIGHT: return { origin.x - origin.w, origin.y - origin.h };
+		case AnchorType::ANCHOR_BOT_MID:   return { origin.x - origin.w / 2, origin.y - origin.h };
+		case AnchorType::ANCHOR_BOT_LEFT:  return { origin.x, origin.y - origin.h };
+		case AnchorType::ANCHOR_LEFT_MID:  return { origin.x, origin.y - origin.h / 2 };
+		case AnchorType::ANCHOR_CENTER:    return { origin.x - origin.w / 2, origin.y - origin.h / 2 };
+	}
+	return { origin.x, origin.y };
+}
+
 void zbj::setAnchorPt(AnchorType anchorType) {
+	bool changed = this->anchor[ID] != anchorType;  // show() re-applies the same anchor every frame
 	this->anchor[ID] = anchorType;
-	Anchor& b = bounds[ID];
-	
-	switch(anchorType) {
-		case AnchorType::ANCHOR_TOP_LEFT:
-			b.current.x = b.origin.x;
-			b.current.y = b.origin.y;
-			break;
-		case AnchorType::ANCHOR_TOP_MID:
-			b.current.x = b.origin.x - b.origin.w / 2;
-			b.current.y = b.origin.y;
-			break;
-		case AnchorType::ANCHOR_TOP_RIGHT:
-			b.current.x = b.origin.x - b.origin.w;
-			b.current.y = b.origin.y;
-			break;
-		case AnchorType::ANCHOR_RIGHT_MID:
-			b.current.x = b.origin.x - b.origin.w;
-			b.current.y = b.origin.y - b.origin.h / 2;
-			break;
-		case AnchorType::ANCHOR_BOT_RIGHT:
-			b.current.x = b.origin.x - b.origin.w;
-			b.current.y = b.origin.y - b.origin.h;
-			break;
-		case AnchorType::ANCHOR_BOT_MID:
-			b.current.x = b.origin.x - b.origin.w / 2;
-			b.current.y = b.origin.y - b.origin.h;
-			break;
-		case AnchorType::ANCHOR_BOT_LEFT:
-			b.current.x = b.origin.x;
-			b.current.y = b.origin.y - b.origin.h;
-			break;
-		case AnchorType::ANCHOR_LEFT_MID:
-			b.current.x = b.origin.x;
-			b.current.y = b.origin.y - b.origin.h / 2;
-			break;
-		case AnchorType::ANCHOR_CENTER:
-			b.current.x = b.origin.x - b.origin.w / 2;
-			b.current.y = b.origin.y - b.origin.h / 2;
-			break;
-	}
+	bounds[ID].current = anchorPos(bounds[ID].origin, anchorType);
+	if (changed) touch();
 }
 
+// Placed by the item's anchor as show() would place it now, even before the next show()
 const Bound zbj::getRealBound(size_t index) const {
 	Bound b = bounds[index].origin;
-	b.x = bounds[index].current.x;
-	b.y = bounds[index].current.y;
+	Point p = anchorPos(b, anchor[index]);
+	b.x = p.x;
+	b.y = p.y;
 	return b;
 }
 
+AnchorType zbj::getAnchor(size_t index) const {
+	return anchor[index];
+}
+
+bool zbj::isDirty() const {
+	return dirty;
+}
+
+// Union of the drawn items' bounds as show() would place them now
+Bound zbj::getExtent() const {
+	Bound extent = { 0, 0, 0, 0 };
+	for (size_t i = head; i != NO_SLOT; i = slots[i].next) {
+		if (!isDrawn(i)) continue;
+		Point p = anchorPos(bounds[i].origin, anchor[i]);
+		Bound b = { p.x, p.y, bounds[i].origin.w, bounds[i].origin.h };
+		if (SDL_RectEmpty(&extent)) extent = b;
+		else SDL_GetRectUnion(&extent, &b, &extent);
+	}
+	return extent;
+}
+
+const Bound& zbj::getShownExtent() const {
+	return shown;
+}
+
+// Pixels that need repainting: where the object was last presented plus where it is now
+bool zbj::getDamage(Bound& damage) const {
+	if (!dirty) return false;
+	Bound now = getExtent();
+	if (SDL_RectEmpty(&shown)) damage = now;
+	else if (SDL_RectEmpty(&now)) damage = shown;
+	else SDL_GetRectUnion(&shown, &now, &damage);
+	return !SDL_RectEmpty(&damage);
+}
+
+bool zbj::isDrawn(size_t index) const {
+	return isAlive(index) && (textures[index] || items[index].prim || items[index].text || items[index].painter || items[index].evicted || items[index].deferred);
+}
+
+bool zbj::isAlive(size_t index) const {
+	return index < slots.size() && slots[index].alive;
+}
+
+bool zbj::isValid(ItemHandle handle) const {
+	return isAlive(handle.index) && slots[handle.index].generation == handle.generation;
+}
+
+ItemHandle zbj::getHandle(size_t index) const {
+	if (!isAlive(index)) return INVALID_ITEM;
+	return { static_cast<Uint32>(index), slots[index].generation };
+}
+
+// Compares items of this object by draw order, whenever each one was drawn or indexed
+Uint64 zbj::getOrder(size_t index) const {
+	return index < slots.size() ? slots[index].order : 0;
+}
+
+size_t zbj::getCount() const {
+	return count;
+}
+
+bool zbj::isPending(size_t index) const {
+	return index < items.size() && !items[index].pending.empty();
+}
+
 const size_t& zbj::getID() const {
 	return ID;
 }
@@ -287,4 +869,8 @@ const std::vector<Anchor>& zbj::getBounds() const {
 
 const std::vector<Texture>& zbj::getTextures() const {
 	return textures;
+}
+
+const std::vector<Item>& zbj::getItems() const {
+	return items;
 }
\ No newline at end of file
@@ -1,27 +1,121 @@
 #include "zfont.h"
+#include "zloader.h"
+#include "zpack.h"
 
 zfont::zfont(){}
 zfont::~zfont(){
 	cleanUpFonts();
 }
 
+// Registers name -> file and opens the requested size, so a bad file fails here; the file is read
+// once, other sizes are opened lazily from that buffer
 bool zfont::loadFont(const std::string& name, size_t size, const std::string& path) {
-	std::string key = name + "_" + std::to_string(size);
-	if (fonts.count(key)) return true;
-	TTF_Font* font = TTF_OpenFont(path.c_str(), size);
-	if (!font) { std::cerr << "Error: Could not load font:\n" << path << "\n" << SDL_GetError() << "\n"; return false; }
-	fonts[key] = { font, size };
+	auto file = filesByPath.find(path);
+	if (file == filesByPath.end() && addPacked(path)) file = filesByPath.find(path);
+	if (file == filesByPath.end()) {
+		size_t bytes = 0;
+		void* data = SDL_LoadFile(path.c_str(), &bytes);
+		if (!data) { std::cerr << "Error: Could not load font:\n" << path << "\n" << SDL_GetError() << "\n"; return false; }
+		files.push_back({ data, bytes, true });
+		file = filesByPath.emplace(path, files.size() - 1).first;
+	}
+	families[name] = file->second;
+	return get(getHandle(name, static_cast<int>(size))) != nullptr;
+}
+
+// Font files baked into a mounted zpack are used in place, nothing is read or copied
+bool zfont::addPacked(const std::string& path) {
+	PackAsset asset;
+	if (!zpack::find(path.c_str(), asset) || asset.entry->kind != static_cast<Uint32>(PackKind::FILE)) return false;
+	files.push_back({ const_cast<Uint8*>(asset.data), static_cast<size_t>(asset.entry->size), false });
+	filesByPath.emplace(path, files.size() - 1);
+	return true;
+}
+
+// Same as loadFont(), but the file is read on a zloader worker; get() returns nullptr until it arrives
+bool zfont::loadFontAsync(const std::string& name, size_t size, const std::string& path) {
+	auto file = filesByPath.find(path);
+	if (file == filesByPath.end() && addPacked(path)) file = filesByPath.find(path);
+	if (file == filesByPath.end()) {
+		size_t index = files.size();
+		files.push_back({ nullptr, 0, true });
+		file = filesByPath.emplace(path, index).first;
+		zloader::loadFile(path.c_str(), this, [this, index](void* data, size_t bytes) {
+			if (files[index].data) SDL_free(data);  // adopted meanwhile
+			else files[index] = { data, bytes, true };
+		});
+	}
+	families[name] = file->second;
+	return getHandle(name, static_cast<int>(size)) != INVALID_FONT;
+}
+
+// Registers a font file read elsewhere (e.g. by zmanifest); takes ownership of data
+bool zfont::adoptFont(const std::string& name, const std::string& path, void* data, size_t bytes) {
+	if (!data) { std::cerr << "Error: Invalid font data for " << name << "!\n"; return false; }
+	auto file = filesByPath.find(path);
+	if (file == filesByPath.end()) {
+		files.push_back({ data, bytes, true });
+		file = filesByPath.emplace(path, files.size() - 1).first;
+	} else if (!files[file->second].data) {
+		files[file->second] = { data, bytes, true };
+	} else {
+		SDL_free(data);
+	}
+	families[name] = file->second;
 	return true;
 }
 
-const Font zfont::getFont(const std::string& name, int size) const{
-	std::string key = name + "_" + std::to_string(size);
-	if (fonts.count(key)) { return fonts.at(key).font; }
-	return nullptr;
+// Resolve once at setup; the handle then costs one array index per use
+FontHandle zfont::getHandle(const std::string& name, int size) {
+	return find(name, size);
+}
+
+FontHandle zfont::find(const std::string& name, int size) const {
+	auto family = families.find(name);
+	if (family == families.end()) return INVALID_FONT;
+	for (size_t i = 0; i < slots.size(); i++) {
+		if (slots[i].file == family->second && slots[i].size == size) return static_cast<FontHandle>(i);
+	}
+	slots.push_back({ family->second, size, nullptr });
+	return static_cast<FontHandle>(slots.size() - 1);
+}
+
+bool zfont::open(FontSlot& slot) const {
+	const FontFile& f = files[slot.file];
+	if (!f.data) return false;  // still loading
+	SDL_IOStream* io = SDL_IOFromConstMem(f.data, f.size);
+	slot.font = io ? TTF_OpenFontIO(io, true, static_cast<float>(slot.size)) : nullptr;
+	if (!slot.font) { std::cerr << "Error: Could not open font size " << slot.size << ": " << SDL_GetError() << "\n"; return false; }
+	return true;
+}
+
+Font zfont::get(FontHandle handle) {
+	if (handle < 0 || static_cast<size_t>(handle) >= slots.size()) return nullptr;
+	FontSlot& slot = slots[handle];
+	if (!slot.font && !open(slot)) return nullptr;
+	return slot.font;
+}
+
+bool zfont::isReady(FontHandle handle) const {
+	return handle >= 0 && static_cast<size_t>(handle) < slots.size() && files[slots[handle].file].data;
+}
+
+const Font zfont::getFont(const std::string& name, int size) const {
+	FontHandle handle = find(name, size);
+	if (handle == INVALID_FONT) return nullptr;
+	FontSlot& slot = slots[handle];
+	if (!slot.font && !open(slot)) return nullptr;
+	return slot.font;
 }
 
 bool zfont::cleanUpFonts() {
-	for (auto& [key, data] : fonts) { TTF_CloseFont(data.font); }
-	fonts.clear();
+	zloader::cancel(this);
+	// Fonts read from the shared buffers, close them before freeing the data
+	for (auto& slot : slots) { if (slot.font) TTF_CloseFont(slot.font); }
+	for (auto& file : files) { if (file.owned) SDL_free(file.data); }
+	slots.clear();
+	files.clear();
+	filesByPath.clear();
+	families.clear();
 	return true;
-}
\ No newline at end of file
+}
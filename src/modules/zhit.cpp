@@ -0,0 +1,153 @@
+#include "zhit.h"
+#include <algorithm>
+#include <cmath>
+
+static int cellOf(int v, int size) {
+	return v >= 0 ? v / size : -((-v + size - 1) / size);
+}
+
+static Uint64 cellKey(int cx, int cy) {
+	return (static_cast<Uint64>(static_cast<Uint32>(cx)) << 32) | static_cast<Uint32>(cy);
+}
+
+static bool contains(const Bound& b, FPoint p) {
+	return p.x >= b.x && p.y >= b.y && p.x < b.x + b.w && p.y < b.y + b.h;
+}
+
+zhit::zhit(int cellSize) : cellSize(std::max(1, cellSize)), nextOrder(1) {}
+
+zhit::~zhit() {
+	for (auto& [obj, reg] : objects) obj->setHitIndex(nullptr);
+}
+
+// Indexes every drawn item of obj; an object added again only changes its z
+void zhit::add(zbj& obj, int z) {
+	auto it = objects.find(&obj);
+	if (it != objects.end()) { setZ(obj, z); return; }
+	Registered& reg = objects[&obj];
+	reg.z = z;
+	reg.order = nextOrder++;
+	obj.setHitIndex(this);
+	for (size_t i = 0; i < obj.getBounds().size(); i++) update(obj, i);
+}
+
+bool zhit::remove(zbj& obj) {
+	auto it = objects.find(&obj);
+	if (it == objects.end()) return false;
+	for (size_t i = 0; i < it->second.entries.size(); i++) erase(it->second, i);
+	objects.erase(it);
+	obj.setHitIndex(nullptr);
+	return true;
+}
+
+void zhit::setZ(zbj& obj, int z) {
+	auto it = objects.find(&obj);
+	if (it == objects.end()) { std::cerr << "Error: zbj is not part of this hit index!" << std::endl; return; }
+	it->second.z = z;
+}
+
+// Called by zbj whenever item `item` may have moved, resized, appeared or gone
+void zhit::update(zbj& obj, size_t item) {
+	auto it = objects.find(&obj);
+	if (it == objects.end()) return;
+	Registered& reg = it->second;
+	Bound b = obj.isDrawn(item) ? obj.getRealBound(item) : Bound{ 0, 0, 0, 0 };
+	if (SDL_RectEmpty(&b)) { erase(reg, item); return; }
+	if (item >= reg.entries.size()) reg.entries.resize(item + 1, NO_ENTRY);
+	Uint32 id = reg.entries[item];
+	if (id != NO_ENTRY) {
+		if (SDL_RectsEqual(&entries[id].bound, &b)) return;
+		eraseCells(id);
+		entries[id].bound = b;
+		insertCells(id);
+		return;
+	}
+	if (!freeEntries.empty()) {
+		id = freeEntries.back();
+		freeEntries.pop_back();
+	} else {
+		id = static_cast<Uint32>(entries.size());
+		entries.emplace_back();
+	}
+	entries[id] = { &obj, item, b };
+	reg.entries[item] = id;
+	insertCells(id);
+}
+
+void zhit::erase(Registered& reg, size_t item) {
+	if (item >= reg.entries.size() || reg.entries[item] == NO_ENTRY) return;
+	Uint32 id = reg.entries[item];
+	eraseCells(id);
+	freeEntries.push_back(id);
+	reg.entries[item] = NO_ENTRY;
+}
+
+void zhit::insertCells(Uint32 id) {
+	const Bound& b = entries[id].bound;
+	int x1 = cellOf(b.x + b.w - 1, cellSize), y1 = cellOf(b.y + b.h - 1, cellSize);
+	for (int cy = cellOf(b.y, cellSize); cy <= y1; cy++) {
+		for (int cx = cellOf(b.x, cellSize); cx <= x1; cx++) cells[cellKey(cx, cy)].push_back(id);
+	}
+}
+
+// Order inside a cell does not matter, so removal swaps with the last id
+void zhit::eraseCells(Uint32 id) {
+	const Bound& b = entries[id].bound;
+	int x1 = cellOf(b.x + b.w - 1, cellSize), y1 = cellOf(b.y + b.h - 1, cellSize);
+	for (int cy = cellOf(b.y, cellSize); cy <= y1; cy++) {
+		for (int cx = cellOf(b.x, cellSize); cx <= x1; cx++) {
+			auto cell = cells.find(cellKey(cx, cy));
+			if (cell == cells.end()) continue;
+			std::vector<Uint32>& ids = cell->second;
+			auto at = std::find(ids.begin(), ids.end(), id);
+			if (at == ids.end()) continue;
+			*at = ids.back();
+			ids.pop_back();
+			if (ids.empty()) cells.erase(cell);
+		}
+	}
+}
+
+bool zhit::above(const Entry& a, const Entry& b) const {
+	const Registered& ra = objects.at(a.obj);
+	const Registered& rb = objects.at(b.obj);
+	if (ra.z != rb.z) return ra.z > rb.z;
+	if (ra.order != rb.order) return ra.order > rb.order;
+	return a.obj->getOrder(a.item) > b.obj->getOrder(b.item);
+}
+
+// Topmost item under p; only the items sharing p's cell are tested
+bool zhit::hit(FPoint p, HitResult& out) const {
+	auto cell = cells.find(cellKey(cellOf(static_cast<int>(std::floor(p.x)), cellSize), cellOf(static_cast<int>(std::floor(p.y)), cellSize)));
+	if (cell == cells.end()) return false;
+	const Entry* top = nullptr;
+	for (Uint32 id : cell->second) {
+		const Entry& e = entries[id];
+		if (!contains(e.bound, p)) continue;
+		if (!top || above(e, *top)) top = &e;
+	}
+	if (!top) return false;
+	out = { top->obj, top->item };
+	return true;
+}
+
+// Every item under p, topmost first
+size_t zhit::hitAll(FPoint p, std::vector<HitResult>& out) const {
+	auto cell = cells.find(cellKey(cellOf(static_cast<int>(std::floor(p.x)), cellSize), cellOf(static_cast<int>(std::floor(p.y)), cellSize)));
+	if (cell == cells.end()) return 0;
+	std::vector<const Entry*> found;
+	for (Uint32 id : cell->second) {
+		if (contains(entries[id].bound, p)) found.push_back(&entries[id]);
+	}
+	std::sort(found.begin(), found.end(), [this](const Entry* a, const Entry* b) { return above(*a, *b); });
+	for (const Entry* e : found) out.push_back({ e->obj, e->item });
+	return found.size();
+}
+
+bool zhit::has(const zbj& obj) const {
+	return objects.count(const_cast<zbj*>(&obj)) != 0;
+}
+
+size_t zhit::size() const {
+	return entries.size() - freeEntries.size();
+}
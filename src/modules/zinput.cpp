@@ -0,0 +1,211 @@
+#include "zinput.h"
+#include <algorithm>
+
+static constexpr int PEEK_BATCH = 64;
+
+zinput::zinput(zhit& hits) : hits(hits), queue(PEEK_BATCH), state{}, hover{ nullptr, 0 }, pressed{ nullptr, 0 }, pressedButton(0), pressPos{ 0, 0 }, nextID(1), depth(0), stale(false) {}
+
+// Every event of an SDL type, e.g. SDL_EVENT_QUIT or SDL_EVENT_KEY_DOWN
+Subscription zinput::on(Uint32 type, EventCallback cb) {
+	Subscription id = nextID++;
+	types[type].push_back({ id, std::move(cb) });
+	return id;
+}
+
+// Pointer events over one item of obj, or over any of its items; obj has to be part of the hit index
+Subscription zinput::on(zbj& obj, PointerKind kind, PointerCallback cb, size_t item) {
+	if (kind == PointerKind::COUNT) { std::cerr << "Error: Invalid pointer kind!" << std::endl; return INVALID_SUBSCRIPTION; }
+	if (!hits.has(obj)) { std::cerr << "Error: zbj is not part of the hit index!" << std::endl; return INVALID_SUBSCRIPTION; }
+	Subscription id = nextID++;
+	regions[&obj].subs[static_cast<int>(kind)].push_back({ id, item, std::move(cb) });
+	return id;
+}
+
+// Callbacks may unsubscribe while being dispatched (even themselves), so entries are only
+// marked here and erased by prune() once no dispatch is running
+void zinput::off(Subscription id) {
+	for (auto& [type, subs] : types) {
+		for (TypeSub& s : subs) if (s.id == id) s.id = INVALID_SUBSCRIPTION;
+	}
+	for (auto& [obj, region] : regions) {
+		for (auto& subs : region.subs) {
+			for (PointerSub& s : subs) if (s.id == id) s.id = INVALID_SUBSCRIPTION;
+		}
+	}
+	stale = true;
+	if (depth == 0) prune();
+}
+
+void zinput::off(zbj& obj) {
+	auto it = regions.find(&obj);
+	if (it != regions.end()) {
+		for (auto& subs : it->second.subs) {
+			for (PointerSub& s : subs) s.id = INVALID_SUBSCRIPTION;
+		}
+	}
+	if (hover.obj == &obj) hover = { nullptr, 0 };
+	if (pressed.obj == &obj) pressed = { nullptr, 0 };
+	stale = true;
+	if (depth == 0) prune();
+}
+
+void zinput::prune() {
+	for (auto it = types.begin(); it != types.end();) {
+		auto& subs = it->second;
+		subs.erase(std::remove_if(subs.begin(), subs.end(), [](const TypeSub& s) { return s.id == INVALID_SUBSCRIPTION; }), subs.end());
+		it = subs.empty() ? types.erase(it) : std::next(it);
+	}
+	for (auto it = regions.begin(); it != regions.end();) {
+		bool empty = true;
+		for (auto& subs : it->second.subs) {
+			subs.erase(std::remove_if(subs.begin(), subs.end(), [](const PointerSub& s) { return s.id == INVALID_SUBSCRIPTION; }), subs.end());
+			empty = empty && subs.empty();
+		}
+		it = empty ? regions.erase(it) : std::next(it);
+	}
+	stale = false;
+}
+
+// Pumps once and dispatches everything queued; returns the number of events handled
+size_t zinput::poll() {
+	size_t handled = 0;
+	SDL_PumpEvents();
+	for (;;) {
+		int got = SDL_PeepEvents(queue.data(), PEEK_BATCH, SDL_GETEVENT, SDL_EVENT_FIRST, SDL_EVENT_LAST);
+		if (got < 0) { std::cerr << "Error: Could not read events: " << SDL_GetError() << std::endl; break; }
+		for (int i = 0; i < got; i++) dispatch(queue[i]);
+		handled += got;
+		if (got < PEEK_BATCH) break;
+	}
+	state.buttons = SDL_GetMouseState(&state.mouse.x, &state.mouse.y);
+	state.mods = SDL_GetModState();
+	state.keys = SDL_GetKeyboardState(nullptr);
+	state.hasFocus = SDL_GetMouseFocus() != nullptr;
+	// Items may have moved under a still pointer (layout, animation): one query catches that
+	retarget(state.mouse);
+	return handled;
+}
+
+// Sleeps until an event arrives, then handles it with everything else queued
+bool zinput::wait(Sint32 timeoutMS) {
+	Event e;
+	if (!SDL_WaitEventTimeout(&e, timeoutMS)) return false;
+	dispatch(e);
+	poll();
+	return true;
+}
+
+// Also accepts events read elsewhere (e.g. zmain::waitEvent())
+void zinput::dispatch(const Event& e) {
+	depth++;
+	pointer(e);
+	auto it = types.find(e.type);
+	if (it != types.end()) {
+		// Callbacks may subscribe, which appends: only the ones present now get this event
+		std::deque<TypeSub>& subs = it->second;
+		for (size_t i = 0, n = subs.size(); i < n; i++) {
+			if (subs[i].id != INVALID_SUBSCRIPTION) subs[i].cb(e);
+		}
+	}
+	depth--;
+	if (depth == 0 && stale) prune();
+}
+
+void zinput::pointer(const Event& e) {
+	switch (e.type) {
+		case SDL_EVENT_MOUSE_MOTION: {
+			FPoint pos = { e.motion.x, e.motion.y };
+			state.mouse = pos;
+			state.hasFocus = true;
+			retarget(pos);
+			if (pressed.obj) {
+				Target t = pressed;
+				deliver(t, PointerKind::DRAG, { t.obj, t.item, pos, { e.motion.xrel, e.motion.yrel }, pressPos, pressedButton });
+			}
+			break;
+		}
+		case SDL_EVENT_MOUSE_BUTTON_DOWN: {
+			FPoint pos = { e.button.x, e.button.y };
+			state.mouse = pos;
+			state.buttons |= SDL_BUTTON_MASK(e.button.button);
+			retarget(pos);
+			if (pressed.obj || !hover.obj) break;   // the first button held owns the drag
+			Target t = hover;
+			pressed = t;
+			pressedButton = e.button.button;
+			pressPos = pos;
+			deliver(t, PointerKind::PRESS, { t.obj, t.item, pos, { 0, 0 }, pos, pressedButton });
+			break;
+		}
+		case SDL_EVENT_MOUSE_BUTTON_UP: {
+			FPoint pos = { e.button.x, e.button.y };
+			state.mouse = pos;
+			state.buttons &= ~SDL_BUTTON_MASK(e.button.button);
+			retarget(pos);
+			if (!pressed.obj || e.button.button != pressedButton) break;
+			Target t = pressed;
+			pressed = { nullptr, 0 };
+			if (!hits.has(*t.obj)) break;  // unregistered while held
+			PointerEvent pe = { t.obj, t.item, pos, { 0, 0 }, pressPos, e.button.button };
+			deliver(t, PointerKind::RELEASE, pe);
+			// A region that covers the whole object clicks even when another of its items is on top
+			bool sameObj = hover.obj == t.obj;
+			deliver(t, PointerKind::CLICK, pe, sameObj, sameObj && hover.item == t.item);
+			break;
+		}
+		case SDL_EVENT_WINDOW_MOUSE_LEAVE:
+			state.hasFocus = false;
+			retarget(state.mouse);
+			break;
+		case SDL_EVENT_WINDOW_MOUSE_ENTER:
+			state.hasFocus = true;
+			break;
+		default:
+			break;
+	}
+}
+
+// Moves the hover to the topmost item under pos. Moving between items of the same object is an
+// ENTER/LEAVE only for regions bound to a single item.
+void zinput::retarget(FPoint pos) {
+	Target next = { nullptr, 0 };
+	HitResult h;
+	if (state.hasFocus && hits.hit(pos, h)) next = { h.obj, h.item };
+	if (next.obj == hover.obj && next.item == hover.item) return;
+	Target prev = hover;
+	hover = next;
+	bool sameObj = prev.obj == next.obj;
+	if (prev.obj && hits.has(*prev.obj)) {
+		deliver(prev, PointerKind::LEAVE, { prev.obj, prev.item, pos, { 0, 0 }, { 0, 0 }, 0 }, !sameObj, true);
+	}
+	if (next.obj) {
+		deliver(next, PointerKind::ENTER, { next.obj, next.item, pos, { 0, 0 }, { 0, 0 }, 0 }, !sameObj, true);
+	}
+}
+
+void zinput::deliver(const Target& t, PointerKind kind, const PointerEvent& e, bool toAny, bool toItem) {
+	auto it = regions.find(t.obj);
+	if (it == regions.end()) return;
+	std::deque<PointerSub>& subs = it->second.subs[static_cast<int>(kind)];
+	depth++;
+	for (size_t i = 0, n = subs.size(); i < n; i++) {
+		const PointerSub& s = subs[i];
+		if (s.id == INVALID_SUBSCRIPTION) continue;
+		if (s.item == ANY_ITEM ? !toAny : (!toItem || s.item != t.item)) continue;
+		s.cb(e);
+	}
+	depth--;
+	if (depth == 0 && stale) prune();
+}
+
+const InputState& zinput::getState() const {
+	return state;
+}
+
+bool zinput::isHovered(const zbj& obj, size_t item) const {
+	return hover.obj == &obj && (item == ANY_ITEM || hover.item == item);
+}
+
+bool zinput::isPressed(const zbj& obj, size_t item) const {
+	return pressed.obj == &obj && (item == ANY_ITEM || pressed.item == item);
+}
@@ -0,0 +1,205 @@
+#include "zlayout.h"
+#include <algorithm>
+#include <cmath>
+
+// Which point of a box an anchor names, as fractions of its size
+static FPoint anchorFraction(AnchorType type) {
+	switch(type) {
+		case AnchorType::ANCHOR_TOP_LEFT:  return { 0.0f, 0.0f };
+		case AnchorType::ANCHOR_TOP_MID:   return { 0.5f, 0.0f };
+		case AnchorType::ANCHOR_TOP_RIGHT: return { 1.0f, 0.0f };
+		case AnchorType::ANCHOR_RIGHT_MID: return { 1.0f, 0.5f };
+		case AnchorType::ANCHOR_BOT_RIGHT: return { 1.0f, 1.0f };
+		case AnchorType::ANCHOR_BOT_MID:   return { 0.5f, 1.0f };
+		case AnchorType::ANCHOR_BOT_LEFT:  return { 0.0f, 1.0f };
+		case AnchorType::ANCHOR_LEFT_MID:  return { 0.0f, 0.5f };
+		case AnchorType::ANCHOR_CENTER:    return { 0.5f, 0.5f };
+	}
+	return { 0.0f, 0.0f };
+}
+
+static float resolve(const Length& l, float parent, int content) {
+	if (l.content) return static_cast<float>(content);
+	return l.px + parent * l.percent / 100.0f;
+}
+
+zlayout::zlayout(int w, int h) : placed(0) {
+	nodes.push_back({ INVALID_NODE, {}, LayoutSpec(), { 0, 0, w, h }, 0, 0, 0, false, {} });
+}
+
+bool zlayout::valid(LayoutNode node) const {
+	return node >= 0 && static_cast<size_t>(node) < nodes.size();
+}
+
+void zlayout::invalidate(LayoutNode node) {
+	if (nodes[node].dirty) return;
+	nodes[node].dirty = true;
+	queue.push_back(node);
+}
+
+LayoutNode zlayout::add(LayoutNode parent, const LayoutSpec& spec) {
+	if (!valid(parent)) { std::cerr << "Error: Invalid layout parent " << parent << "!" << std::endl; return INVALID_NODE; }
+	LayoutNode node = static_cast<LayoutNode>(nodes.size());
+	nodes.push_back({ parent, {}, spec, { 0, 0, 0, 0 }, 0, 0, nodes[parent].depth + 1, false, {} });
+	nodes[parent].children.push_back(node);
+	invalidate(parent);
+	return node;
+}
+
+// The parent places the node, the node places its children (padding, gap, flex may have changed)
+bool zlayout::setSpec(LayoutNode node, const LayoutSpec& spec) {
+	if (!valid(node)) { std::cerr << "Error: Invalid layout node " << node << "!" << std::endl; return false; }
+	nodes[node].spec = spec;
+	if (node != LAYOUT_ROOT) invalidate(nodes[node].parent);
+	invalidate(node);
+	return true;
+}
+
+// Only a node sized by its content moves anything, through its parent
+bool zlayout::setContentSize(LayoutNode node, int w, int h) {
+	if (!valid(node)) { std::cerr << "Error: Invalid layout node " << node << "!" << std::endl; return false; }
+	Node& n = nodes[node];
+	if (n.contentW == w && n.contentH == h) return true;
+	n.contentW = w;
+	n.contentH = h;
+	if (node != LAYOUT_ROOT && (n.spec.w.content || n.spec.h.content)) invalidate(n.parent);
+	return true;
+}
+
+// Places zbj item `item` on the node's box, respecting the item's own anchor. An unmeasured
+// node takes the item's current size as its content size (e.g. a drawn text).
+bool zlayout::bind(LayoutNode node, zbj& obj, ItemHandle item) {
+	if (!valid(node)) { std::cerr << "Error: Invalid layout node " << node << "!" << std::endl; return false; }
+	if (!obj.isValid(item)) { std::cerr << "Error: Invalid item " << item.index << " to bind!" << std::endl; return false; }
+	Node& n = nodes[node];
+	n.bindings.push_back({ &obj, item });
+	if (n.contentW == 0 && n.contentH == 0) {
+		const Bound& b = obj.getBounds()[item.index].origin;
+		setContentSize(node, b.w, b.h);
+	}
+	if (!SDL_RectEmpty(&n.box)) apply(n);
+	return true;
+}
+
+// The item as it is now: removing it later drops the binding even if its slot is reused
+bool zlayout::bind(LayoutNode node, zbj& obj, size_t item) {
+	if (!obj.isAlive(item)) { std::cerr << "Error: Invalid item " << item << " to bind!" << std::endl; return false; }
+	return bind(node, obj, obj.getHandle(item));
+}
+
+void zlayout::unbind(zbj& obj) {
+	for (Node& n : nodes) {
+		n.bindings.erase(std::remove_if(n.bindings.begin(), n.bindings.end(), [&](const Binding& b) { return b.obj == &obj; }), n.bindings.end());
+	}
+}
+
+void zlayout::setSize(int w, int h) {
+	Node& root = nodes[LAYOUT_ROOT];
+	if (root.box.w == w && root.box.h == h) return;
+	root.box = { 0, 0, w, h };
+	apply(root);
+	invalidate(LAYOUT_ROOT);
+}
+
+// Returns the number of boxes computed; 0 when nothing changed since the last call
+size_t zlayout::update() {
+	placed = 0;
+	if (queue.empty()) return 0;
+	// Parents first: placing one already places every descendant whose box changed
+	std::sort(queue.begin(), queue.end(), [this](LayoutNode a, LayoutNode b) { return nodes[a].depth < nodes[b].depth; });
+	for (LayoutNode node : queue) {
+		if (nodes[node].dirty) place(node);
+	}
+	queue.clear();
+	return placed;
+}
+
+// Computes the boxes of node's children and walks into those that changed or were marked
+void zlayout::place(LayoutNode node) {
+	Node& n = nodes[node];
+	n.dirty = false;
+	if (n.children.empty()) return;
+	const LayoutSpec& s = n.spec;
+	FBound inner = {
+		n.box.x + s.padding,
+		n.box.y + s.padding,
+		std::max(0.0f, n.box.w - 2.0f * s.padding),
+		std::max(0.0f, n.box.h - 2.0f * s.padding) };
+
+	bool flex = s.flex != FlexDirection::NONE;
+	bool row = s.flex == FlexDirection::ROW;
+	float grow = 0.0f, used = 0.0f;
+	if (flex) {
+		for (LayoutNode c : n.children) {
+			const Node& child = nodes[c];
+			used += row ? resolve(child.spec.w, inner.w, child.contentW) : resolve(child.spec.h, inner.h, child.contentH);
+			grow += child.spec.grow;
+		}
+		used += s.gap * (n.children.size() - 1);
+	}
+	float free = std::max(0.0f, (row ? inner.w : inner.h) - used);
+	float cursor = row ? inner.x : inner.y;
+
+	for (LayoutNode c : n.children) {
+		Node& child = nodes[c];
+		const LayoutSpec& cs = child.spec;
+		float w = resolve(cs.w, inner.w, child.contentW);
+		float h = resolve(cs.h, inner.h, child.contentH);
+		if (flex && grow > 0.0f) (row ? w : h) += free * cs.grow / grow;
+		FPoint f = anchorFraction(cs.anchor);
+		float x = inner.x + f.x * (inner.w - w) + resolve(cs.x, inner.w, 0);
+		float y = inner.y + f.y * (inner.h - h) + resolve(cs.y, inner.h, 0);
+		if (flex && row) { x = cursor + resolve(cs.x, inner.w, 0); cursor += w + s.gap; }
+		if (flex && !row) { y = cursor + resolve(cs.y, inner.h, 0); cursor += h + s.gap; }
+
+		Bound box = {
+			static_cast<int>(std::lround(x)), static_cast<int>(std::lround(y)),
+			static_cast<int>(std::lround(w)), static_cast<int>(std::lround(h)) };
+		placed++;
+		if (!SDL_RectsEqual(&box, &child.box)) {
+			child.box = box;
+			apply(child);
+			place(c);
+		} else if (child.dirty) {
+			place(c);
+		}
+	}
+}
+
+// Writes the box into every bound item; zbj anchors an item's origin, so the origin is the
+// box point the item's anchor names
+void zlayout::apply(Node& n) {
+	// Items removed since, their slot possibly taken by another item, are unbound for good
+	n.bindings.erase(std::remove_if(n.bindings.begin(), n.bindings.end(), [](const Binding& b) { return !b.obj->isValid(b.item); }), n.bindings.end());
+	for (const Binding& b : n.bindings) {
+		FPoint f = anchorFraction(b.obj->getAnchor(b.item.index));
+		Bound origin = {
+			n.box.x + static_cast<int>(f.x * n.box.w),
+			n.box.y + static_cast<int>(f.y * n.box.h),
+			n.box.w, n.box.h };
+		size_t saved = b.obj->getID();
+		b.obj->setActiveID(b.item.index);
+		b.obj->setBound(origin);
+		if (b.obj->isAlive(saved)) b.obj->setActiveID(saved);
+	}
+}
+
+const Bound& zlayout::getBox(LayoutNode node) const {
+	return nodes[valid(node) ? node : LAYOUT_ROOT].box;
+}
+
+const LayoutSpec& zlayout::getSpec(LayoutNode node) const {
+	return nodes[valid(node) ? node : LAYOUT_ROOT].spec;
+}
+
+bool zlayout::isDirty() const {
+	return !queue.empty();
+}
+
+size_t zlayout::getPlaced() const {
+	return placed;
+}
+
+size_t zlayout::size() const {
+	return nodes.size();
+}
@@ -0,0 +1,226 @@
+#include "zloader.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class JobKind { SURFACE, FILE };
+
+struct LoadJob {
+	JobKind kind;
+	std::string path;
+	Surface surface;
+	void* data;
+	size_t size;
+	std::string error;  // SDL_GetError() is per thread, copied out on the worker
+	LoadJob* next;      // link in the finished stack
+};
+
+struct Waiter {
+	const void* owner;
+	SurfaceCallback onSurface;
+	FileCallback onFile;
+};
+
+using JobKey = std::pair<JobKind, std::string>;
+
+struct LoaderState {
+	std::vector<std::thread> workers;
+	std::mutex mutex;                           // guards queue and stopping
+	std::condition_variable wake;
+	std::deque<LoadJob*> queue;
+	bool stopping = false;
+	std::atomic<LoadJob*> finished{ nullptr };  // Treiber stack, pushed by workers, emptied by pump()
+	Uint32 eventType = 0;                       // set before the workers start, 0 when none could be registered
+
+	// Main thread only
+	std::deque<LoadJob*> ready;                 // taken off the stack, waiting for pump budget
+	std::map<JobKey, std::vector<Waiter>> waiters;
+	size_t inFlight = 0;
+};
+
+static LoaderState& state() {
+	// Never destroyed: zmain stops the workers explicitly, possibly during static destruction
+	static auto* s = new LoaderState();
+	return *s;
+}
+
+// SDL_PushEvent is thread safe: wakes a main thread blocked in SDL_WaitEvent
+static void notify(const LoaderState& s) {
+	if (s.eventType == 0) return;
+	Event e;
+	SDL_zero(e);
+	e.type = s.eventType;
+	SDL_PushEvent(&e);
+}
+
+static void work(LoaderState& s) {
+	for (;;) {
+		LoadJob* job;
+		{
+			std::unique_lock<std::mutex> lock(s.mutex);
+			s.wake.wait(lock, [&] { return s.stopping || !s.queue.empty(); });
+			if (s.stopping) return;
+			job = s.queue.front();
+			s.queue.pop_front();
+		}
+		if (job->kind == JobKind::SURFACE) job->surface = IMG_Load(job->path.c_str());
+		else job->data = SDL_LoadFile(job->path.c_str(), &job->size);
+		if (!job->surface && !job->data) job->error = SDL_GetError();
+		LoadJob* head = s.finished.load(std::memory_order_relaxed);
+		do job->next = head;
+		while (!s.finished.compare_exchange_weak(head, job, std::memory_order_release, std::memory_order_relaxed));
+		// One event per batch: results pushed onto a non-empty stack go with the pump already due
+		if (!head) notify(s);
+	}
+}
+
+static void destroyJob(LoadJob* job) {
+	if (job->surface) SDL_DestroySurface(job->surface);
+	SDL_free(job->data);
+	delete job;
+}
+
+void zloader::start(size_t threads) {
+	LoaderState& s = state();
+	if (!s.workers.empty()) return;
+	// Decoding is mostly IO and zlib, a few workers saturate it; leave one core to the render thread
+	if (threads == 0) threads = std::clamp<size_t>(std::thread::hardware_concurrency(), 2, 5) - 1;
+	if (s.eventType == 0) s.eventType = SDL_RegisterEvents(1);
+	s.stopping = false;
+	for (size_t i = 0; i < threads; i++) s.workers.emplace_back(work, std::ref(s));
+}
+
+// Joins the workers and drops every result not delivered yet; called by ~zmain before SDL_Quit
+void zloader::stop() {
+	LoaderState& s = state();
+	{
+		std::lock_guard<std::mutex> lock(s.mutex);
+		s.stopping = true;
+	}
+	s.wake.notify_all();
+	for (auto& t : s.workers) t.join();
+	s.workers.clear();
+	for (LoadJob* job : s.queue) destroyJob(job);
+	s.queue.clear();
+	for (LoadJob* job = s.finished.exchange(nullptr); job;) {
+		LoadJob* next = job->next;
+		destroyJob(job);
+		job = next;
+	}
+	for (LoadJob* job : s.ready) destroyJob(job);
+	s.ready.clear();
+	s.waiters.clear();
+	s.inFlight = 0;
+}
+
+static void request(JobKind kind, const char* path, Waiter&& waiter) {
+	LoaderState& s = state();
+	auto inserted = s.waiters.try_emplace(JobKey(kind, path));
+	inserted.first->second.push_back(std::move(waiter));
+	if (!inserted.second) return;  // already in flight, the result is shared
+	if (s.workers.empty()) zloader::start();
+	LoadJob* job = new LoadJob{ kind, path, nullptr, nullptr, 0, {}, nullptr };
+	{
+		std::lock_guard<std::mutex> lock(s.mutex);
+		s.queue.push_back(job);
+	}
+	s.wake.notify_one();
+	s.inFlight++;
+}
+
+bool zloader::loadSurface(const char* path, const void* owner, SurfaceCallback done) {
+	if (!path || !done) { std::cerr << "Error: Invalid image path or callback!\n"; return false; }
+	request(JobKind::SURFACE, path, { owner, std::move(done), nullptr });
+	return true;
+}
+
+bool zloader::loadFile(const char* path, const void* owner, FileCallback done) {
+	if (!path || !done) { std::cerr << "Error: Invalid file path or callback!\n"; return false; }
+	request(JobKind::FILE, path, { owner, nullptr, std::move(done) });
+	return true;
+}
+
+// Drops owner's callbacks, e.g. from a destructor; the load itself still finishes
+void zloader::cancel(const void* owner) {
+	for (auto& [key, list] : state().waiters) {
+		list.erase(std::remove_if(list.begin(), list.end(), [&](const Waiter& w) { return w.owner == owner; }), list.end());
+	}
+}
+
+// Drops owner's callbacks for one path only, e.g. when the item that waited on it is removed
+void zloader::cancel(const void* owner, const char* path) {
+	for (auto& [key, list] : state().waiters) {
+		if (key.second != path) continue;
+		list.erase(std::remove_if(list.begin(), list.end(), [&](const Waiter& w) { return w.owner == owner; }), list.end());
+	}
+}
+
+static void deliver(LoaderState& s, LoadJob* job) {
+	std::vector<Waiter> list;
+	auto it = s.waiters.find(JobKey(job->kind, job->path));
+	if (it != s.waiters.end()) {
+		// Taken out first: callbacks may request or cancel loads themselves
+		list = std::move(it->second);
+		s.waiters.erase(it);
+	}
+	if (job->kind == JobKind::SURFACE) {
+		if (!job->surface) std::cerr << "Error: Could not load image! " << job->error << std::endl;
+		for (auto& w : list) w.onSurface(job->surface);
+	} else {
+		if (!job->data) std::cerr << "Error: Could not load file:\n" << job->path << "\n" << job->error << std::endl;
+		for (size_t i = 0; i < list.size(); i++) {
+			// Every waiter but the last gets a copy it owns, the last one takes the buffer itself
+			void* data = job->data;
+			if (i + 1 < list.size() && data) {
+				data = SDL_malloc(job->size);
+				if (data) std::memcpy(data, job->data, job->size);
+			} else {
+				job->data = nullptr;
+			}
+			list[i].onFile(data, data ? job->size : 0);
+		}
+	}
+	destroyJob(job);
+}
+
+// Runs finished callbacks until budgetNS is spent, the rest waits for the next frame.
+// At least one result is delivered per call, so a slow upload can not stall loading.
+size_t zloader::pump(Uint64 budgetNS) {
+	LoaderState& s = state();
+	if (s.inFlight == 0) return 0;
+	// The stack is newest first; reversed so results arrive in completion order
+	LoadJob* taken = s.finished.exchange(nullptr, std::memory_order_acquire);
+	size_t at = s.ready.size();
+	for (; taken; taken = taken->next) s.ready.insert(s.ready.begin() + at, taken);
+
+	Uint64 start = SDL_GetTicksNS();
+	size_t delivered = 0;
+	while (!s.ready.empty() && (delivered == 0 || SDL_GetTicksNS() - start < budgetNS)) {
+		LoadJob* job = s.ready.front();
+		s.ready.pop_front();
+		s.inFlight--;
+		delivered++;
+		deliver(s, job);
+	}
+	// Left for the next call: a loop about to sleep has to come back for them
+	if (!s.ready.empty()) notify(s);
+	return delivered;
+}
+
+// Requests not delivered yet, including ones still queued for a worker
+size_t zloader::getPending() {
+	return state().inFlight;
+}
+
+// 0 until the first request; the event carries nothing, pump() picks up the results
+Uint32 zloader::getEventType() {
+	return state().eventType;
+}
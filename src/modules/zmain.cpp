@@ -1,11 +1,29 @@
 #include "zmain.h"
+#include "ztexcache.h"
+#include "zatlas.h"
+#include "zbatch.h"
+#include "zscene.h"
+#include "zprof.h"
+#include "ztextengine.h"
+#include "zloader.h"
+#include "ztexbudget.h"
+#include <cstring>
+
+static constexpr size_t MAX_DAMAGE_RECTS = 16;
 
 zmain::zmain(){
 	window = nullptr; 
 	renderer = nullptr;
+	software = false;
+	partial = true;
+	hud = false;
+	targetNS = 0;
+	vsync = SDL_RENDERER_VSYNC_DISABLED;
+	frameStart = 0;
+	stats = {};
 }
 
-zmain::zmain(const WinData& wd) {
+zmain::zmain(const WinData& wd) : window(nullptr), renderer(nullptr), software(false), partial(true), hud(false), targetNS(0), vsync(SDL_RENDERER_VSYNC_DISABLED), frameStart(0), stats{} {
 	if (!initZketch(wd)) {
 		std::cerr << "Error: Could not initialize zmain\n";
 	} else {
@@ -39,11 +57,23 @@ bool zmain::initZketch(const WinData& wd) {
 		SDL_Quit();
 		return false;
 	}
+	software = std::strcmp(SDL_GetRendererName(renderer), SDL_SOFTWARE_RENDERER) == 0;
 	return true;
 }
 
 bool zmain::present(){
-	return SDL_RenderPresent(renderer);
+	zbatch& batch = zbatch::get(renderer);
+	bool ok;
+	{
+		ZPROF_SCOPE(ProfSection::PRESENT);
+		batch.flush();
+		if(hud) zprof::drawHUD(renderer);
+		ok = SDL_RenderPresent(renderer);
+	}
+	batch.endFrame();
+	ztexbudget::get(renderer).endFrame();
+	zprof::endFrame(batch.getDrawCalls());
+	return ok;
 }
 
 WinData zmain::getWinSize() const {
@@ -54,7 +84,22 @@ Renderer& zmain::getRenderer() {
 	return renderer;
 }
 
+size_t zmain::getDrawCalls() const {
+	return zbatch::get(renderer).getDrawCalls();
+}
+
+bool zmain::isSoftware() const {
+	return software;
+}
+
+// Delivers finished zloader results (images, files); call once per loop before updating the scene
+size_t zmain::pump(){
+	return zloader::pump();
+}
+
 bool zmain::clearRender(Color color){
+	ZPROF_SCOPE(ProfSection::CLEAR);
+	zbatch::get(renderer).flush();
 	if(!SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a)){
 		std::cerr << "Error: Could not set color: " << SDL_GetError() << "\n";
 		return false;
@@ -66,22 +111,166 @@ bool zmain::clearRender(Color color){
 	return true;
 }
 
+// Clears, draws and presents the scene only when something in it changed
+bool zmain::render(zscene& scene, Color color){
+	if(!scene.isDirty()) return false;
+	bool ok = true;
+	// The HUD changes every frame, so it needs the full redraw
+	if(software && partial && !hud && renderDamage(scene, color, ok)){
+		scene.markClean();
+		return ok;
+	}
+	if(!clearRender(color)) return false;
+	scene.show();
+	ok = present();
+	scene.markClean();
+	return ok;
+}
+
+// Clips rects to the screen and merges overlapping ones; false when a full redraw is cheaper
+static bool mergeDamage(std::vector<Bound>& rects, const Bound& screen){
+	size_t n = 0;
+	for(const Bound& r : rects){
+		Bound clipped;
+		if(SDL_GetRectIntersection(&r, &screen, &clipped)) rects[n++] = clipped;
+	}
+	rects.resize(n);
+	for(bool merged = true; merged;){
+		merged = false;
+		for(size_t i = 0; i < rects.size() && !merged; i++){
+			for(size_t j = i + 1; j < rects.size(); j++){
+				if(!SDL_HasRectIntersection(&rects[i], &rects[j])) continue;
+				Bound u;
+				SDL_GetRectUnion(&rects[i], &rects[j], &u);
+				rects[i] = u;
+				rects.erase(rects.begin() + j);
+				merged = true;
+				break;
+			}
+		}
+	}
+	long long area = 0;
+	for(const Bound& r : rects) area += static_cast<long long>(r.w) * r.h;
+	return rects.size() <= MAX_DAMAGE_RECTS && area * 4 < static_cast<long long>(screen.w) * screen.h * 3;
+}
+
+// Software path: clear and redraw only the damaged rects, then copy just those to the window.
+// Returns false when the caller should fall back to a full redraw.
+bool zmain::renderDamage(zscene& scene, Color color, bool& ok){
+	damage.clear();
+	if(!scene.collectDamage(damage)) return false;
+	int w = 0, h = 0;
+	if(!SDL_GetCurrentRenderOutputSize(renderer, &w, &h)) return false;
+	if(!mergeDamage(damage, { 0, 0, w, h })) return false;
+	if(damage.empty()) return true;
+
+	zbatch& batch = zbatch::get(renderer);
+	batch.flush();
+	for(const Bound& r : damage){
+		SDL_SetRenderClipRect(renderer, &r);
+		{
+			ZPROF_SCOPE(ProfSection::CLEAR);
+			// SDL_RenderClear ignores the clip rect, so each rect is cleared with a fill
+			FBound f;
+			SDL_RectToFRect(&r, &f);
+			SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+			SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+			SDL_RenderFillRect(renderer, &f);
+		}
+		scene.show(r);
+		batch.flush();
+	}
+	SDL_SetRenderClipRect(renderer, nullptr);
+	{
+		ZPROF_SCOPE(ProfSection::PRESENT);
+		ok = SDL_FlushRenderer(renderer) && SDL_UpdateWindowSurfaceRects(window, damage.data(), static_cast<int>(damage.size()));
+	}
+	if(!ok) std::cerr << "Error: Could not update window surface: " << SDL_GetError() << "\n";
+	batch.endFrame();
+	ztexbudget::get(renderer).endFrame();
+	zprof::endFrame(batch.getDrawCalls());
+	return true;
+}
+
+// Draws zprof's summary over every presented frame and turns the profiler on with it
+void zmain::setProfilerHUD(bool enable){
+	hud = enable;
+	if(enable) zprof::setEnabled(true);
+}
+
+// Texture bytes zbj items may hold before the least recently shown are evicted, 0 = unlimited
+void zmain::setTextureBudget(size_t bytes){
+	ztexbudget::get(renderer).setBudget(bytes);
+}
+
+// Only has an effect with the software renderer, hardware renderers always redraw the frame
+void zmain::setPartialRedraw(bool enable){
+	partial = enable;
+}
+
+// Blocks until an event arrives (or the timeout passes) instead of spinning on an idle frame
+bool zmain::waitEvent(Event& e, Sint32 timeoutMS){
+	return SDL_WaitEventTimeout(&e, timeoutMS);
+}
+
 void zmain::delay(Uint32 ms){
 	SDL_Delay(ms);
 }
 
+// 0 removes the limit; pace() then only records frame times
+void zmain::setTargetFPS(int fps){
+	targetNS = fps > 0 ? SDL_NS_PER_SECOND / static_cast<Uint64>(fps) : 0;
+	frameStart = SDL_GetTicksNS();
+}
+
+// 1 syncs every refresh, 2 every second one, SDL_RENDERER_VSYNC_ADAPTIVE or 0 to disable
+bool zmain::setVSync(int interval){
+	if(!SDL_SetRenderVSync(renderer, interval)){
+		std::cerr << "Error: Could not set vsync: " << SDL_GetError() << "\n";
+		return false;
+	}
+	vsync = interval;
+	return true;
+}
+
+// Call once per loop after rendering: sleeps only for what is left of the frame budget.
+// Deadlines are absolute so sleep error does not accumulate; a missed one restarts from now.
+void zmain::pace(){
+	Uint64 now = SDL_GetTicksNS();
+	if(frameStart == 0) frameStart = now;
+	stats.workNS = now - frameStart;
+	stats.frames++;
+	// With vsync the present already blocks until the next refresh
+	if(targetNS == 0 || vsync != SDL_RENDERER_VSYNC_DISABLED){
+		stats.frameNS = stats.workNS;
+		frameStart = now;
+		return;
+	}
+	Uint64 deadline = frameStart + targetNS;
+	if(now < deadline){
+		SDL_DelayPrecise(deadline - now);
+		frameStart = deadline;
+	}else{
+		stats.missed++;
+		frameStart = now;
+	}
+	stats.frameNS = SDL_GetTicksNS() - (now - stats.workNS);
+}
+
+const FrameStats& zmain::getFrameStats() const {
+	return stats;
+}
+
 void zmain::updateWinSize(){
 	SDL_GetWindowSize(window, &wd.w, &wd.h);
 }
 
+// Decoded by zloader, the icon is set on the first frame after it arrives
 void zmain::setWindowIcon(const char* path){
-	SDL_Surface* icon = IMG_Load(path);
-	if (icon) {
+	zloader::loadSurface(path, this, [this](Surface icon) {
+		if (!icon) { std::cerr << "Error: Could not load icon!\n"; return; }
 		SDL_SetWindowIcon(window, icon);
-		SDL_DestroySurface(icon);
-	} else {
-		std::cerr << "Error: Could not load icon!: " << SDL_GetError() << "\n";
-	}
+	});
 }
 
 void zmain::startTextInput(){
@@ -99,7 +288,13 @@ void zmain::stopTextInput(){
 }
 
 zmain::~zmain() {
+	zloader::stop();
 	if (renderer) {
+		ztextengine::drop(renderer);
+		ztexbudget::drop(renderer);
+		ztexcache::drop(renderer);
+		zatlas::drop(renderer);
+		zbatch::drop(renderer);
 		SDL_DestroyRenderer(renderer);
 	}
 	if (window) {
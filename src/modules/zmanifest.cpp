@@ -0,0 +1,190 @@
+#include "zmanifest.h"
+#include "zloader.h"
+#include "ztexcache.h"
+#include "zpack.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+zmanifest::zmanifest(Renderer renderer, zfont& fonts)
+	: renderer(renderer), fonts(fonts), finished(0), failed(0), startNS(0), endNS(0) {}
+
+zmanifest::~zmanifest() {
+	zloader::cancel(this);
+}
+
+bool zmanifest::load(const char* path) {
+	std::ifstream in(path);
+	if (!in) { std::cerr << "Error: Could not open manifest " << path << "!" << std::endl; return false; }
+	bool ok = true;
+	std::string line;
+	for (int lineNo = 1; std::getline(in, line); lineNo++) {
+		line.erase(std::min(line.find('#'), line.size()));
+		std::istringstream words(line);
+		std::string kind;
+		if (!(words >> kind)) continue;
+		Asset a = {};
+		if (kind == "font") a.kind = AssetKind::FONT;
+		else if (kind == "image") a.kind = AssetKind::IMAGE;
+		else { std::cerr << "Error: " << path << ":" << lineNo << ": unknown asset kind '" << kind << "'!" << std::endl; ok = false; continue; }
+		if (!(words >> a.name >> a.path)) { std::cerr << "Error: " << path << ":" << lineNo << ": expected a name and a path!" << std::endl; ok = false; continue; }
+		bool valid = true;
+		for (std::string word; words >> word;) {
+			if (word.rfind("after=", 0) == 0) a.after = word.substr(6);
+			else if (a.kind == AssetKind::IMAGE && word == "pack") a.pack = true;
+			else if (a.kind == AssetKind::FONT && std::atoi(word.c_str()) > 0) a.sizes.push_back(std::atoi(word.c_str()));
+			else { std::cerr << "Error: " << path << ":" << lineNo << ": unexpected '" << word << "'!" << std::endl; valid = false; }
+		}
+		if (a.kind == AssetKind::FONT && a.sizes.empty()) { std::cerr << "Error: " << path << ":" << lineNo << ": font needs at least one size!" << std::endl; valid = false; }
+		ok &= valid && add(a);
+	}
+	return ok;
+}
+
+bool zmanifest::add(const Asset& asset) {
+	if (startNS) { std::cerr << "Error: Could not add " << asset.name << " - manifest already started!" << std::endl; return false; }
+	if (byName.count(asset.name)) { std::cerr << "Error: Duplicate asset name " << asset.name << "!" << std::endl; return false; }
+	byName[asset.name] = assets.size();
+	assets.push_back(asset);
+	Asset& a = assets.back();
+	a.requested = a.done = a.ok = false;
+	a.requestNS = a.loadNS = a.finishNS = 0;
+	return true;
+}
+
+// Requests every asset whose dependency is met; later ones follow from complete()
+bool zmanifest::start() {
+	if (startNS) { std::cerr << "Error: Manifest already started!" << std::endl; return false; }
+	// Unknown names and cycles would leave assets waiting forever, so they are rejected up front
+	for (const Asset& a : assets) {
+		size_t steps = 0;
+		for (const Asset* at = &a; !at->after.empty(); steps++) {
+			auto dep = byName.find(at->after);
+			if (dep == byName.end()) { std::cerr << "Error: " << at->name << " depends on unknown asset " << at->after << "!" << std::endl; return false; }
+			if (steps > assets.size()) { std::cerr << "Error: Dependency cycle at asset " << a.name << "!" << std::endl; return false; }
+			at = &assets[dep->second];
+		}
+	}
+	startNS = SDL_GetTicksNS();
+	if (assets.empty()) endNS = startNS;
+	for (size_t i = 0; i < assets.size(); i++) {
+		if (assets[i].after.empty()) request(i);
+	}
+	return true;
+}
+
+void zmanifest::request(size_t index) {
+	Asset& a = assets[index];
+	a.requested = true;
+	a.requestNS = SDL_GetTicksNS();
+	// Packed assets are mapped and decoded already, there is nothing for a worker to do
+	PackAsset asset;
+	if (zpack::find(a.path.c_str(), asset)) {
+		if (a.kind == AssetKind::FONT) a.ok = fonts.loadFont(a.name, a.sizes.front(), a.path) && openSizes(a);
+		else a.ok = preload(a, nullptr);
+		a.finishNS = SDL_GetTicksNS() - a.requestNS;
+		complete(index);
+		return;
+	}
+	bool queued = a.kind == AssetKind::FONT
+		? zloader::loadFile(a.path.c_str(), this, [this, index](void* data, size_t size) { finishFont(index, data, size); })
+		: zloader::loadSurface(a.path.c_str(), this, [this, index](Surface s) { finishImage(index, s); });
+	if (!queued) complete(index);
+}
+
+void zmanifest::finishFont(size_t index, void* data, size_t size) {
+	Asset& a = assets[index];
+	Uint64 now = SDL_GetTicksNS();
+	a.loadNS = now - a.requestNS;
+	a.ok = data && fonts.adoptFont(a.name, a.path, data, size) && openSizes(a);
+	a.finishNS = SDL_GetTicksNS() - now;
+	complete(index);
+}
+
+// Every size is opened now instead of on first draw, so the first frame does no font work
+bool zmanifest::openSizes(const Asset& a) {
+	for (int pt : a.sizes) {
+		if (!fonts.get(fonts.getHandle(a.name, pt))) return false;
+	}
+	return true;
+}
+
+// Uploaded into the shared cache and released again: the entry stays resident for draw(path)
+// from objects whose packing matches the asset's
+bool zmanifest::preload(const Asset& asset, Surface s) {
+	ztexcache& cache = ztexcache::get(renderer);
+	FBound src;
+	Texture t = cache.acquire(asset.path.c_str(), src, asset.pack, s);
+	if (t) cache.release(t, src);
+	return t != nullptr;
+}
+
+void zmanifest::finishImage(size_t index, Surface s) {
+	Asset& a = assets[index];
+	Uint64 now = SDL_GetTicksNS();
+	a.loadNS = now - a.requestNS;
+	a.ok = s && preload(a, s);
+	a.finishNS = SDL_GetTicksNS() - now;
+	complete(index);
+}
+
+void zmanifest::complete(size_t index) {
+	Asset& a = assets[index];
+	a.done = true;
+	finished++;
+	if (!a.ok) failed++;
+	// Dependents go even when this asset failed, one missing file must not stall the rest
+	for (size_t i = 0; i < assets.size(); i++) {
+		if (!assets[i].requested && assets[i].after == a.name) request(i);
+	}
+	if (finished == assets.size()) endNS = SDL_GetTicksNS();
+}
+
+// Blocks until every asset is in, running zloader's callbacks on this thread; meant for
+// startup before the first frame. Without it, zmain::pump() delivers them loop by loop.
+bool zmanifest::wait() {
+	if (!startNS && !start()) return false;
+	while (!isDone()) {
+		if (zloader::pump(SDL_MAX_UINT64) == 0) SDL_DelayNS(100 * SDL_NS_PER_US);
+	}
+	return failed == 0;
+}
+
+bool zmanifest::isDone() const {
+	return startNS && finished == assets.size();
+}
+
+float zmanifest::getProgress() const {
+	return assets.empty() ? 1.0f : static_cast<float>(finished) / assets.size();
+}
+
+const char* zmanifest::getPath(const std::string& name) const {
+	auto it = byName.find(name);
+	if (it == byName.end()) { std::cerr << "Error: Unknown asset " << name << "!" << std::endl; return nullptr; }
+	return assets[it->second].path.c_str();
+}
+
+const std::vector<Asset>& zmanifest::getAssets() const {
+	return assets;
+}
+
+// Start to last delivery, or up to now while loading
+Uint64 zmanifest::getTotalNS() const {
+	if (!startNS) return 0;
+	return (endNS ? endNS : SDL_GetTicksNS()) - startNS;
+}
+
+// Per asset times, then the wall time next to the sum of all asset times
+void zmanifest::printReport() const {
+	Uint64 serial = 0;
+	std::printf("%-24s %-6s %10s %10s  %s\n", "asset", "kind", "load ms", "finish ms", "status");
+	for (const Asset& a : assets) {
+		serial += a.loadNS + a.finishNS;
+		std::printf("%-24s %-6s %10.2f %10.2f  %s\n", a.name.c_str(), a.kind == AssetKind::FONT ? "font" : "image",
+			a.loadNS / 1e6, a.finishNS / 1e6, !a.done ? "loading" : a.ok ? "ok" : "failed");
+	}
+	std::printf("%zu assets, %zu failed, total %.2f ms (sum of assets %.2f ms)\n", assets.size(), failed, getTotalNS() / 1e6, serial / 1e6);
+}
@@ -0,0 +1,156 @@
+#include "zpack.h"
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+struct PackMount {
+	std::string path;
+	const Uint8* base = nullptr;
+	size_t size = 0;
+#ifdef _WIN32
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = nullptr;
+#endif
+	std::unordered_map<std::string, const PackEntry*> index;
+
+	~PackMount();
+};
+
+PackMount::~PackMount() {
+#ifdef _WIN32
+	if (base) UnmapViewOfFile(base);
+	if (mapping) CloseHandle(mapping);
+	if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+	if (base) munmap(const_cast<Uint8*>(base), size);
+#endif
+}
+
+static std::vector<std::unique_ptr<PackMount>>& mounts() {
+	// Never destroyed: fonts opened from a pack may still read it during static destruction
+	static auto* m = new std::vector<std::unique_ptr<PackMount>>();
+	return *m;
+}
+
+static bool mapFile(PackMount& m) {
+#ifdef _WIN32
+	m.file = CreateFileA(m.path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (m.file == INVALID_HANDLE_VALUE) return false;
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m.file, &size) || size.QuadPart == 0) return false;
+	m.size = static_cast<size_t>(size.QuadPart);
+	m.mapping = CreateFileMappingA(m.file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!m.mapping) return false;
+	m.base = static_cast<const Uint8*>(MapViewOfFile(m.mapping, FILE_MAP_READ, 0, 0, 0));
+	return m.base != nullptr;
+#else
+	int fd = open(m.path.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+	struct stat st;
+	bool ok = fstat(fd, &st) == 0 && st.st_size > 0;
+	if (ok) {
+		m.size = static_cast<size_t>(st.st_size);
+		void* p = mmap(nullptr, m.size, PROT_READ, MAP_PRIVATE, fd, 0);
+		ok = p != MAP_FAILED;
+		if (ok) m.base = static_cast<const Uint8*>(p);
+	}
+	close(fd);  // the mapping keeps the file alive
+	return ok;
+#endif
+}
+
+// Checks every record against the mapped size so a truncated pack can not read out of bounds
+static bool buildIndex(PackMount& m) {
+	if (m.size < sizeof(PackHeader)) return false;
+	PackHeader header;
+	std::memcpy(&header, m.base, sizeof(header));
+	if (std::memcmp(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0 || header.version != PACK_VERSION) return false;
+	Uint64 names = sizeof(PackHeader) + static_cast<Uint64>(header.count) * sizeof(PackEntry);
+	if (names + header.namesSize > m.size) return false;
+	const PackEntry* entries = reinterpret_cast<const PackEntry*>(m.base + sizeof(PackHeader));
+	const char* blob = reinterpret_cast<const char*>(m.base + names);
+	for (Uint32 i = 0; i < header.count; i++) {
+		const PackEntry& e = entries[i];
+		if (e.offset > m.size || e.size > m.size - e.offset) return false;
+		if (static_cast<Uint64>(e.nameOffset) + e.nameLength > header.namesSize) return false;
+		if (e.kind == static_cast<Uint32>(PackKind::IMAGE) && static_cast<Uint64>(e.pitch) * e.h > e.size) return false;
+		m.index[std::string(blob + e.nameOffset, e.nameLength)] = &e;
+	}
+	return true;
+}
+
+bool zpack::mount(const char* path) {
+	if (!path) { std::cerr << "Error: Invalid pack path!\n"; return false; }
+	unmount(path);
+	auto m = std::make_unique<PackMount>();
+	m->path = path;
+	if (!mapFile(*m)) { std::cerr << "Error: Could not map pack " << path << "!" << std::endl; return false; }
+	if (!buildIndex(*m)) { std::cerr << "Error: " << path << " is not a valid zketch pack!" << std::endl; return false; }
+	mounts().push_back(std::move(m));
+	return true;
+}
+
+// Textures made from the pack are copies, but fonts read it directly: close them first
+bool zpack::unmount(const char* path) {
+	auto& m = mounts();
+	for (auto it = m.begin(); it != m.end(); ++it) {
+		if ((*it)->path != path) continue;
+		m.erase(it);
+		return true;
+	}
+	return false;
+}
+
+void zpack::unmountAll() {
+	mounts().clear();
+}
+
+bool zpack::find(const char* name, PackAsset& out) {
+	auto& m = mounts();
+	if (m.empty() || !name) return false;
+	std::string key = normalize(name);
+	for (auto it = m.rbegin(); it != m.rend(); ++it) {
+		auto e = (*it)->index.find(key);
+		if (e == (*it)->index.end()) continue;
+		out = { e->second, (*it)->base + e->second->offset };
+		return true;
+	}
+	return false;
+}
+
+// Wraps the mapped pixels without copying; destroy the surface, the pixels stay in the pack
+Surface zpack::surface(const PackAsset& asset) {
+	const PackEntry& e = *asset.entry;
+	if (e.kind != static_cast<Uint32>(PackKind::IMAGE)) { std::cerr << "Error: Pack entry is not an image!\n"; return nullptr; }
+	// Read-only mapping: the surface is only ever a source for uploads and blits
+	Surface s = SDL_CreateSurfaceFrom(e.w, e.h, static_cast<SDL_PixelFormat>(e.format), const_cast<Uint8*>(asset.data), e.pitch);
+	if (!s) std::cerr << "Error: Could not wrap packed image! " << SDL_GetError() << std::endl;
+	return s;
+}
+
+// Pack names use forward slashes without a leading "./", whatever the caller passed
+std::string zpack::normalize(const char* path) {
+	std::string name = path;
+	for (char& c : name) {
+		if (c == '\\') c = '/';
+	}
+	while (name.compare(0, 2, "./") == 0) name.erase(0, 2);
+	return name;
+}
+
+size_t zpack::getMounted() {
+	return mounts().size();
+}
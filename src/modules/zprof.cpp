@@ -0,0 +1,157 @@
+#include "zprof.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+static const char* SECTION_NAMES[] = { "clear", "show", "draw", "text", "upload", "present" };
+static_assert(sizeof(SECTION_NAMES) / sizeof(SECTION_NAMES[0]) == static_cast<size_t>(ProfSection::COUNT), "section names out of sync");
+
+struct ProfState {
+	bool enabled = false;
+	std::vector<FrameRecord> records;   // ring, grows up to CAPACITY
+	size_t head = 0;                    // next slot to overwrite once full
+	FrameRecord current = {};
+	Uint64 lastPresent = 0;
+};
+
+static ProfState& state() {
+	// Never destroyed: scopes may still run during static destruction
+	static auto* s = new ProfState();
+	return *s;
+}
+
+zprof::Scope::Scope(ProfSection section) : section(section), start(state().enabled ? SDL_GetTicksNS() : 0) {}
+
+zprof::Scope::~Scope() {
+	if (start) zprof::add(section, SDL_GetTicksNS() - start);
+}
+
+void zprof::setEnabled(bool enable) {
+	ProfState& s = state();
+	if (enable && !s.enabled) {
+		s.current = {};
+		s.lastPresent = 0;
+	}
+	s.enabled = enable;
+}
+
+bool zprof::isEnabled() {
+	return state().enabled;
+}
+
+void zprof::add(ProfSection section, Uint64 ns) {
+	ProfState& s = state();
+	if (s.enabled) s.current.sectionNS[static_cast<size_t>(section)] += ns;
+}
+
+void zprof::countTexture() {
+	ProfState& s = state();
+	if (s.enabled) s.current.texturesCreated++;
+}
+
+// Closes the current frame, called by zmain after every present
+void zprof::endFrame(size_t drawCalls) {
+	ProfState& s = state();
+	if (!s.enabled) return;
+	Uint64 now = SDL_GetTicksNS();
+	s.current.frameNS = s.lastPresent ? now - s.lastPresent : 0;
+	s.current.drawCalls = drawCalls;
+	s.lastPresent = now;
+	if (s.current.frameNS > 0) {
+		if (s.records.size() < CAPACITY) s.records.push_back(s.current);
+		else s.records[s.head] = s.current;
+		s.head = (s.head + 1) % CAPACITY;
+	}
+	s.current = {};
+}
+
+void zprof::reset() {
+	ProfState& s = state();
+	s.records.clear();
+	s.head = 0;
+	s.current = {};
+	s.lastPresent = 0;
+}
+
+ProfSummary zprof::getSummary() {
+	const ProfState& s = state();
+	ProfSummary sum = {};
+	sum.frames = s.records.size();
+	if (s.records.empty()) return sum;
+
+	std::vector<Uint64> times;
+	times.reserve(s.records.size());
+	Uint64 total = 0;
+	for (const FrameRecord& r : s.records) {
+		times.push_back(r.frameNS);
+		total += r.frameNS;
+		for (size_t i = 0; i < static_cast<size_t>(ProfSection::COUNT); i++) sum.sectionMS[i] += r.sectionNS[i] / 1e6f;
+	}
+	for (float& ms : sum.sectionMS) ms /= s.records.size();
+
+	auto percentile = [&](float p) {
+		size_t k = std::min(times.size() - 1, static_cast<size_t>(p * times.size()));
+		std::nth_element(times.begin(), times.begin() + k, times.end());
+		return times[k] / 1e6f;
+	};
+	sum.p50MS = percentile(0.50f);
+	sum.p99MS = percentile(0.99f);
+	sum.fps = total ? s.records.size() * 1e9f / total : 0.0f;
+
+	const FrameRecord& last = s.records[(s.head + s.records.size() - 1) % s.records.size()];
+	sum.drawCalls = last.drawCalls;
+	sum.texturesCreated = last.texturesCreated;
+	return sum;
+}
+
+const std::vector<FrameRecord>& zprof::getRecords() {
+	return state().records;
+}
+
+// Oldest record once the ring is full, 0 before that
+size_t zprof::getHead() {
+	const ProfState& s = state();
+	return s.records.size() < CAPACITY ? 0 : s.head;
+}
+
+// Draws the summary with SDL's built-in 8x8 debug font; call before present()
+bool zprof::drawHUD(Renderer renderer, float x, float y) {
+	ProfSummary sum = getSummary();
+	const float line = SDL_DEBUG_TEXT_FONT_CHARACTER_SIZE + 2.0f;
+	char text[4][96];
+	std::snprintf(text[0], sizeof(text[0]), "fps %.1f  p50 %.2fms  p99 %.2fms", sum.fps, sum.p50MS, sum.p99MS);
+	std::snprintf(text[1], sizeof(text[1]), "draw calls %zu  textures %zu", sum.drawCalls, sum.texturesCreated);
+	std::snprintf(text[2], sizeof(text[2]), "clear %.2f  show %.2f  draw %.2f", sum.sectionMS[0], sum.sectionMS[1], sum.sectionMS[2]);
+	std::snprintf(text[3], sizeof(text[3]), "text %.2f  upload %.2f  present %.2f", sum.sectionMS[3], sum.sectionMS[4], sum.sectionMS[5]);
+
+	FBound bg = { x - 4.0f, y - 4.0f, 38 * SDL_DEBUG_TEXT_FONT_CHARACTER_SIZE + 8.0f, 4 * line + 6.0f };
+	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+	SDL_SetRenderDrawColor(renderer, 0, 0, 0, 180);
+	SDL_RenderFillRect(renderer, &bg);
+	SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255);
+	bool ok = true;
+	for (int i = 0; i < 4; i++) ok &= SDL_RenderDebugText(renderer, x, y + i * line, text[i]);
+	if (!ok) std::cerr << "Error: Could not draw profiler HUD! " << SDL_GetError() << std::endl;
+	return ok;
+}
+
+// One row per frame, oldest first, times in microseconds
+bool zprof::dumpCSV(const char* path) {
+	FILE* f = std::fopen(path, "w");
+	if (!f) { std::cerr << "Error: Could not open " << path << " for writing!" << std::endl; return false; }
+	std::fprintf(f, "frame,frame_us");
+	for (const char* name : SECTION_NAMES) std::fprintf(f, ",%s_us", name);
+	std::fprintf(f, ",draw_calls,textures_created\n");
+
+	const ProfState& s = state();
+	size_t start = getHead();
+	for (size_t i = 0; i < s.records.size(); i++) {
+		const FrameRecord& r = s.records[(start + i) % s.records.size()];
+		std::fprintf(f, "%zu,%.1f", i, r.frameNS / 1e3);
+		for (Uint64 ns : r.sectionNS) std::fprintf(f, ",%.1f", ns / 1e3);
+		std::fprintf(f, ",%zu,%zu\n", r.drawCalls, r.texturesCreated);
+	}
+	bool ok = std::fclose(f) == 0;
+	if (!ok) std::cerr << "Error: Could not write " << path << "!" << std::endl;
+	return ok;
+}
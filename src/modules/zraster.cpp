@@ -0,0 +1,94 @@
+#include "zraster.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using FillFn = void (*)(Uint32*, int, Uint32);
+
+static void fillScalar(Uint32* row, int count, Uint32 pixel) {
+	for (int i = 0; i < count; i++) row[i] = pixel;
+}
+
+#ifdef SDL_SSE2_INTRINSICS
+static void SDL_TARGETING("sse2") fillSSE2(Uint32* row, int count, Uint32 pixel) {
+	__m128i v = _mm_set1_epi32(static_cast<int>(pixel));
+	int i = 0;
+	for (; i + 4 <= count; i += 4) _mm_storeu_si128(reinterpret_cast<__m128i*>(row + i), v);
+	for (; i < count; i++) row[i] = pixel;
+}
+#endif
+
+#ifdef SDL_AVX2_INTRINSICS
+static void SDL_TARGETING("avx2") fillAVX2(Uint32* row, int count, Uint32 pixel) {
+	__m256i v = _mm256_set1_epi32(static_cast<int>(pixel));
+	int i = 0;
+	for (; i + 8 <= count; i += 8) _mm256_storeu_si256(reinterpret_cast<__m256i*>(row + i), v);
+	for (; i < count; i++) row[i] = pixel;
+}
+#endif
+
+static FillFn pickFill() {
+#ifdef SDL_AVX2_INTRINSICS
+	if (SDL_HasAVX2()) return fillAVX2;
+#endif
+#ifdef SDL_SSE2_INTRINSICS
+	if (SDL_HasSSE2()) return fillSSE2;
+#endif
+	return fillScalar;
+}
+
+Uint32 zraster::pixel(Color color, Uint8 alpha) {
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+	return (static_cast<Uint32>(color.r) << 24) | (static_cast<Uint32>(color.g) << 16) | (static_cast<Uint32>(color.b) << 8) | alpha;
+#else
+	return static_cast<Uint32>(color.r) | (static_cast<Uint32>(color.g) << 8) | (static_cast<Uint32>(color.b) << 16) | (static_cast<Uint32>(alpha) << 24);
+#endif
+}
+
+void zraster::fillRow(Uint32* row, int count, Uint32 pixel) {
+	static const FillFn fill = pickFill();
+	if (count > 0) fill(row, count, pixel);
+}
+
+// Each corner row is solved from the circle equation: pixels farther than r + 0.5 from the
+// corner centre are empty, nearer than r - 0.5 are solid, and only the few in between get a
+// per-pixel coverage estimate. Bottom rows mirror the top ones, right halves mirror the left.
+void zraster::roundRect(void* pixels, int pitch, int w, int h, float radius, Color color) {
+	if (!pixels || w <= 0 || h <= 0) return;
+	float r = std::max(0.0f, std::min(radius, std::min(w, h) * 0.5f));
+	Uint8* base = static_cast<Uint8*>(pixels);
+	Uint32 solid = pixel(color, color.a);
+	int band = std::min(static_cast<int>(std::ceil(r)), (h + 1) / 2);
+	int half = w / 2;
+
+	for (int y = 0; y < band; y++) {
+		Uint32* row = reinterpret_cast<Uint32*>(base + static_cast<size_t>(y) * pitch);
+		float dy = r - (y + 0.5f);
+		if (dy <= 0.0f) {
+			fillRow(row, w, solid);
+		} else {
+			float outer = (r + 0.5f) * (r + 0.5f) - dy * dy;
+			float inner = (r - 0.5f) * (r - 0.5f) - dy * dy;
+			float extOut = outer > 0.0f ? std::sqrt(outer) : 0.0f;
+			float extIn = (r > 0.5f && inner > 0.0f) ? std::sqrt(inner) : 0.0f;
+			int xa = std::clamp(static_cast<int>(std::floor(r - extOut)), 0, half);
+			int xb = std::clamp(static_cast<int>(std::ceil(r - extIn)), xa, half);
+
+			fillRow(row, xa, 0);
+			fillRow(row + w - xa, xa, 0);
+			for (int x = xa; x < xb; x++) {
+				float dx = std::max(0.0f, r - (x + 0.5f));
+				float coverage = std::clamp(r - std::sqrt(dx * dx + dy * dy) + 0.5f, 0.0f, 1.0f);
+				Uint32 p = pixel(color, static_cast<Uint8>(color.a * coverage + 0.5f));
+				row[x] = p;
+				row[w - 1 - x] = p;
+			}
+			fillRow(row + xb, w - 2 * xb, solid);
+		}
+		int mirror = h - 1 - y;
+		if (mirror != y) std::memcpy(base + static_cast<size_t>(mirror) * pitch, row, static_cast<size_t>(w) * 4);
+	}
+	for (int y = band; y < h - band; y++) {
+		fillRow(reinterpret_cast<Uint32*>(base + static_cast<size_t>(y) * pitch), w, solid);
+	}
+}
@@ -0,0 +1,111 @@
+#include "zscene.h"
+#include <algorithm>
+
+zscene::zscene(Renderer renderer) : renderer(renderer), dirty(true) {}
+
+void zscene::insert(Node&& node) {
+	auto at = std::upper_bound(nodes.begin(), nodes.end(), node.z, [](int z, const Node& n) { return z < n.z; });
+	damage(node.obj->getExtent());
+	nodes.insert(at, std::move(node));
+}
+
+void zscene::damage(const Bound& area) {
+	if (!SDL_RectEmpty(&area)) pending.push_back(area);
+}
+
+zbj& zscene::create(int z) {
+	auto obj = std::make_unique<zbj>(renderer);
+	zbj& ref = *obj;
+	insert({ &ref, z, std::move(obj) });
+	return ref;
+}
+
+void zscene::attach(zbj& obj, int z) {
+	insert({ &obj, z, nullptr });
+}
+
+bool zscene::detach(zbj& obj) {
+	auto it = std::find_if(nodes.begin(), nodes.end(), [&](const Node& n) { return n.obj == &obj; });
+	if (it == nodes.end()) { std::cerr << "Error: zbj is not part of this scene!" << std::endl; return false; }
+	damage(obj.getShownExtent());
+	nodes.erase(it);
+	return true;
+}
+
+void zscene::setZ(zbj& obj, int z) {
+	auto it = std::find_if(nodes.begin(), nodes.end(), [&](const Node& n) { return n.obj == &obj; });
+	if (it == nodes.end()) { std::cerr << "Error: zbj is not part of this scene!" << std::endl; return; }
+	if (it->z == z) return;
+	Node node = std::move(*it);
+	nodes.erase(it);
+	node.z = z;
+	insert(std::move(node));
+}
+
+// Window events that need a repaint even though no node changed
+bool zscene::handle(const Event& e) {
+	switch (e.type) {
+		case SDL_EVENT_WINDOW_SHOWN:
+		case SDL_EVENT_WINDOW_EXPOSED:
+		case SDL_EVENT_WINDOW_RESIZED:
+		case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
+		case SDL_EVENT_WINDOW_MAXIMIZED:
+		case SDL_EVENT_WINDOW_RESTORED:
+		case SDL_EVENT_RENDER_TARGETS_RESET:
+		case SDL_EVENT_RENDER_DEVICE_RESET:
+			// Target texture contents are lost, cached layers have to be composited again
+			for (auto& n : nodes) n.obj->markDirty();
+			dirty = true;
+			return true;
+		default:
+			return false;
+	}
+}
+
+void zscene::invalidate() {
+	dirty = true;
+}
+
+bool zscene::isDirty() const {
+	if (dirty || !pending.empty()) return true;
+	for (const auto& n : nodes) {
+		if (n.obj->isDirty()) return true;
+	}
+	return false;
+}
+
+void zscene::show() {
+	for (auto& n : nodes) {
+		if (n.obj->getCount() > 0) n.obj->show();
+	}
+}
+
+// Rects to repaint since the last markClean(); false when the whole window has to be redrawn
+bool zscene::collectDamage(std::vector<Bound>& rects) const {
+	if (dirty) return false;
+	rects.insert(rects.end(), pending.begin(), pending.end());
+	Bound d;
+	for (const auto& n : nodes) {
+		if (n.obj->getDamage(d)) rects.push_back(d);
+	}
+	return true;
+}
+
+// Draws only the nodes overlapping clip, the caller sets the matching render clip rect
+void zscene::show(const Bound& clip) {
+	for (auto& n : nodes) {
+		if (n.obj->getCount() == 0) continue;
+		Bound extent = n.obj->getExtent();
+		if (SDL_HasRectIntersection(&extent, &clip)) n.obj->show();
+	}
+}
+
+void zscene::markClean() {
+	dirty = false;
+	pending.clear();
+	for (auto& n : nodes) n.obj->markClean();
+}
+
+size_t zscene::size() const {
+	return nodes.size();
+}
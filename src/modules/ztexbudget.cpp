@@ -0,0 +1,107 @@
+#include "ztexbudget.h"
+#include "zbj.h"
+#include <algorithm>
+#include <iterator>
+#include <memory>
+
+static std::unordered_map<Renderer, std::unique_ptr<ztexbudget>>& budgets() {
+	// Never destroyed: zmain drops its entry explicitly, possibly during static destruction
+	static auto* b = new std::unordered_map<Renderer, std::unique_ptr<ztexbudget>>();
+	return *b;
+}
+
+ztexbudget::ztexbudget(Renderer renderer) : renderer(renderer), budget(0), frame(1), nextTicket(1), stats{} {}
+
+ztexbudget& ztexbudget::get(Renderer renderer) {
+	auto& b = budgets();
+	auto it = b.find(renderer);
+	if (it != b.end()) return *it->second;
+	return *b.emplace(renderer, std::make_unique<ztexbudget>(renderer)).first->second;
+}
+
+void ztexbudget::drop(Renderer renderer) {
+	budgets().erase(renderer);
+}
+
+// New textures count as shown now: they were drawn for a reason. A shared cache texture is
+// charged by its first holder only, later holders just join it.
+Uint64 ztexbudget::add(zbj* owner, size_t item, size_t bytes, Texture sharedTexture) {
+	Uint64 ticket = nextTicket++;
+	auto group = sharedTexture ? shared.find(sharedTexture) : shared.end();
+	if (group != shared.end()) {
+		auto it = group->second;
+		it->holders.push_back({ owner, item, ticket });
+		it->shownFrame = frame;
+		lru.splice(lru.begin(), lru, it);
+		residents[ticket] = it;
+		return ticket;
+	}
+	lru.push_front({ sharedTexture, { { owner, item, ticket } }, bytes, frame });
+	residents[ticket] = lru.begin();
+	if (sharedTexture) shared[sharedTexture] = lru.begin();
+	stats.bytes += bytes;
+	stats.residents = lru.size();
+	return ticket;
+}
+
+// The texture stops counting with its last holder
+void ztexbudget::remove(Uint64 ticket) {
+	auto found = residents.find(ticket);
+	if (found == residents.end()) return;
+	auto it = found->second;
+	residents.erase(found);
+	auto& holders = it->holders;
+	holders.erase(std::remove_if(holders.begin(), holders.end(), [&](const Holder& h) { return h.ticket == ticket; }), holders.end());
+	if (holders.empty()) erase(it);
+}
+
+void ztexbudget::erase(std::list<Resident>::iterator it) {
+	for (const Holder& h : it->holders) residents.erase(h.ticket);
+	if (it->shared) shared.erase(it->shared);
+	stats.bytes -= it->bytes;
+	lru.erase(it);
+	stats.residents = lru.size();
+}
+
+void ztexbudget::touch(Uint64 ticket) {
+	auto it = residents.find(ticket);
+	if (it == residents.end() || it->second->shownFrame == frame) return;
+	it->second->shownFrame = frame;
+	lru.splice(lru.begin(), lru, it->second);
+}
+
+// Called by zmain after present: every quad of the frame is submitted, so evicting is safe now
+void ztexbudget::endFrame() {
+	trim();
+	frame++;
+}
+
+void ztexbudget::trim() {
+	while (budget > 0 && stats.bytes > budget && !lru.empty()) {
+		if (lru.back().shownFrame >= frame) break;  // everything older is gone, the rest is in use
+		std::vector<Holder> holders = std::move(lru.back().holders);
+		lru.back().holders.clear();
+		erase(std::prev(lru.end()));
+		for (const Holder& h : holders) residents.erase(h.ticket);
+		stats.evictions++;
+		// Every holder lets go, so the last release destroys a shared cache entry
+		for (const Holder& h : holders) h.owner->evict(h.item, h.ticket);
+	}
+}
+
+// Takes effect at the next endFrame(), textures of the current frame may still be queued
+void ztexbudget::setBudget(size_t bytes) {
+	budget = bytes;
+}
+
+void ztexbudget::countRegeneration() {
+	stats.regenerations++;
+}
+
+size_t ztexbudget::getBudget() const {
+	return budget;
+}
+
+const TexBudgetStats& ztexbudget::getStats() const {
+	return stats;
+}
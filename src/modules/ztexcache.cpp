@@ -0,0 +1,234 @@
+#include "ztexcache.h"
+#include "zatlas.h"
+#include "zprof.h"
+#include "zpack.h"
+#include <filesystem>
+#include <iterator>
+#include <memory>
+
+static std::unordered_map<Renderer, std::unique_ptr<ztexcache>>& caches() {
+	// Never destroyed: zmain drops its entry explicitly, possibly during static destruction
+	static auto* c = new std::unordered_map<Renderer, std::unique_ptr<ztexcache>>();
+	return *c;
+}
+
+ztexcache::ztexcache(Renderer renderer) : renderer(renderer), stats{}, textBudget(8 * 1024 * 1024) {}
+
+ztexcache::~ztexcache() {
+	clear();
+}
+
+ztexcache& ztexcache::get(Renderer renderer) {
+	auto& c = caches();
+	auto it = c.find(renderer);
+	if (it != c.end()) return *it->second;
+	return *c.emplace(renderer, std::make_unique<ztexcache>(renderer)).first->second;
+}
+
+void ztexcache::drop(Renderer renderer) {
+	caches().erase(renderer);
+}
+
+const std::string& ztexcache::canonical(const char* path) {
+	// Fast path: the exact string was seen before, no filesystem access needed
+	auto alias = aliases.find(path);
+	if (alias == aliases.end()) {
+		std::error_code ec;
+		std::string key = std::filesystem::weakly_canonical(path, ec).string();
+		if (ec || key.empty()) key = path;
+		alias = aliases.emplace(path, key).first;
+	}
+	return alias->second;
+}
+
+// Takes a reference only if the image is already resident with the packing asked for, never loads it
+Texture ztexcache::find(const char* path, FBound& src, bool pack, bool* packed) {
+	if (!path) return nullptr;
+	auto it = entries.find(EntryKey(canonical(path), pack));
+	if (it == entries.end()) return nullptr;
+	stats.hits++;
+	it->second.refs++;
+	src = it->second.src;
+	if (packed) *packed = it->second.packed;
+	return it->second.texture;
+}
+
+// decoded, when given, is used instead of IMG_Load on a miss (see zloader); the caller keeps it
+Texture ztexcache::acquire(const char* path, FBound& src, bool pack, Surface decoded, bool* packed) {
+	if (!path) { std::cerr << "Error: Invalid image path!\n"; return nullptr; }
+	Texture hit = find(path, src, pack, packed);
+	if (hit) return hit;
+	EntryKey key(canonical(path), pack);
+	stats.misses++;
+	// A mounted pack holds the pixels decoded already, only the upload is left
+	PackAsset asset;
+	Surface s = decoded ? decoded : zpack::find(path, asset) ? zpack::surface(asset) : IMG_Load(path);
+	if (!s) { std::cerr << "Error: Could not load image! " << SDL_GetError() << std::endl; return nullptr; }
+	Entry e = { nullptr, { 0, 0, static_cast<float>(s->w), static_cast<float>(s->h) }, false, 1, static_cast<size_t>(s->w) * s->h * 4 };
+	AtlasRegion region;
+	if (pack && zatlas::get(renderer).pack(s, region)) {
+		e.texture = region.page;
+		e.src = region.src;
+		e.packed = true;
+	} else {
+		ZPROF_SCOPE(ProfSection::UPLOAD);
+		e.texture = SDL_CreateTextureFromSurface(renderer, s);
+		if (e.texture) zprof::countTexture();
+	}
+	if (s != decoded) SDL_DestroySurface(s);
+	if (!e.texture) { std::cerr << "Error: Could not create texture from image! " << SDL_GetError() << std::endl; return nullptr; }
+	entries[key] = e;
+	owners[Owner(e.texture, e.src.x, e.src.y)] = key;
+	stats.bytes += e.bytes;
+	stats.entries = entries.size();
+	src = e.src;
+	if (packed) *packed = e.packed;
+	return e.texture;
+}
+
+bool ztexcache::TextKey::operator==(const TextKey& o) const {
+	return font == o.font && color == o.color && wrapWidth == o.wrapWidth && text == o.text;
+}
+
+size_t ztexcache::TextKeyHash::operator()(const TextKey& k) const {
+	size_t h = std::hash<std::string>()(k.text);
+	h ^= std::hash<const void*>()(k.font) + 0x9e3779b9 + (h << 6) + (h >> 2);
+	h ^= std::hash<Uint64>()((static_cast<Uint64>(k.color) << 32) | static_cast<Uint32>(k.wrapWidth)) + 0x9e3779b9 + (h << 6) + (h >> 2);
+	return h;
+}
+
+// Rendered string for zbj::draw(Font, ...); a string seen before costs one lookup, no rasterization
+Texture ztexcache::acquireText(const Font font, const char* text, Color color, int wrapWidth, int& w, int& h) {
+	TextKey key = { font, text, (static_cast<Uint32>(color.r) << 24) | (color.g << 16) | (color.b << 8) | color.a, wrapWidth };
+	auto it = texts.find(key);
+	if (it != texts.end()) {
+		stats.textHits++;
+		TextEntry& e = it->second;
+		e.refs++;
+		textLRU.splice(textLRU.begin(), textLRU, e.lru);
+		w = e.w;
+		h = e.h;
+		return e.texture;
+	}
+	stats.textMisses++;
+	size_t length = key.text.size();
+	Surface s = wrapWidth > 0 ? TTF_RenderText_Blended_Wrapped(font, text, length, color, wrapWidth) : TTF_RenderText_Blended(font, text, length, color);
+	if (!s) { std::cerr << "Error: Could not render text! " << SDL_GetError() << std::endl; return nullptr; }
+	Texture t;
+	{
+		ZPROF_SCOPE(ProfSection::UPLOAD);
+		t = SDL_CreateTextureFromSurface(renderer, s);
+	}
+	TextEntry e = { t, s->w, s->h, 1, static_cast<size_t>(s->w) * s->h * 4, {} };
+	SDL_DestroySurface(s);
+	if (!t) { std::cerr << "Error: Could not create texture from text! " << SDL_GetError() << std::endl; return nullptr; }
+	zprof::countTexture();
+
+	auto inserted = texts.emplace(std::move(key), e).first;
+	const TextKey* k = &inserted->first;    // node-based map: stable across rehashing
+	textLRU.push_front(k);
+	inserted->second.lru = textLRU.begin();
+	textOwners[t] = k;
+	stats.textBytes += e.bytes;
+	stats.textEntries = texts.size();
+	trimText();
+	w = e.w;
+	h = e.h;
+	return t;
+}
+
+// Evicts unreferenced strings, least recently used first, until the budget holds
+void ztexcache::trimText() {
+	auto it = textLRU.end();
+	while (stats.textBytes > textBudget && it != textLRU.begin()) {
+		--it;
+		const TextKey* k = *it;
+		if (texts.at(*k).refs > 0) continue;
+		it = std::next(it);
+		destroyText(*k);
+		stats.textEvictions++;
+	}
+}
+
+void ztexcache::destroyText(const TextKey& key) {
+	auto it = texts.find(key);
+	if (it == texts.end()) return;
+	TextEntry& e = it->second;
+	stats.textBytes -= e.bytes;
+	textOwners.erase(e.texture);
+	textLRU.erase(e.lru);
+	SDL_DestroyTexture(e.texture);
+	texts.erase(it);
+	stats.textEntries = texts.size();
+}
+
+void ztexcache::setTextBudget(size_t bytes) {
+	textBudget = bytes;
+	trimText();
+}
+
+// drop destroys the entry right away once it is unreferenced (see ztexbudget)
+bool ztexcache::release(Texture texture, const FBound& src, bool drop) {
+	auto text = textOwners.find(texture);
+	if (text != textOwners.end()) {
+		TextEntry& e = texts.at(*text->second);
+		if (e.refs > 0) e.refs--;
+		if (drop && e.refs == 0) destroyText(*text->second);
+		else trimText();
+		return true;
+	}
+	auto it = owners.find(Owner(texture, src.x, src.y));
+	if (it == owners.end()) return false;
+	Entry& e = entries.at(it->second);
+	if (e.refs > 0) e.refs--;
+	// Unreferenced entries stay resident so a respawned sprite is still a hit; see purge()
+	if (drop && e.refs == 0) destroyEntry(EntryKey(it->second));
+	return true;
+}
+
+void ztexcache::destroyEntry(const EntryKey& key) {
+	auto it = entries.find(key);
+	if (it == entries.end()) return;
+	Entry& e = it->second;
+	stats.bytes -= e.bytes;
+	owners.erase(Owner(e.texture, e.src.x, e.src.y));
+	if (e.packed) zatlas::get(renderer).release(e.texture);
+	else SDL_DestroyTexture(e.texture);
+	entries.erase(it);
+	stats.entries = entries.size();
+}
+
+void ztexcache::purge() {
+	std::vector<EntryKey> unused;
+	for (auto& [key, e] : entries) {
+		if (e.refs == 0) unused.push_back(key);
+	}
+	for (auto& key : unused) destroyEntry(key);
+	std::vector<const TextKey*> unusedText;
+	for (auto& [key, e] : texts) {
+		if (e.refs == 0) unusedText.push_back(&key);
+	}
+	for (const TextKey* key : unusedText) destroyText(*key);
+}
+
+void ztexcache::clear() {
+	for (auto& [key, e] : entries) {
+		if (e.packed) zatlas::get(renderer).release(e.texture);
+		else SDL_DestroyTexture(e.texture);
+	}
+	entries.clear();
+	owners.clear();
+	aliases.clear();
+	stats.bytes = 0;
+	stats.entries = 0;
+	for (auto& [key, e] : texts) SDL_DestroyTexture(e.texture);
+	texts.clear();
+	textOwners.clear();
+	textLRU.clear();
+	stats.textBytes = 0;
+	stats.textEntries = 0;
+}
+
+const TexCacheStats& ztexcache::getStats() const {
+	return stats;
+}
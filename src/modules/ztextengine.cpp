@@ -0,0 +1,41 @@
+#include "ztextengine.h"
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+
+static std::unordered_map<Renderer, std::unique_ptr<ztextengine>>& engines() {
+	// Never destroyed: zmain drops its entry explicitly, possibly during static destruction
+	static auto* e = new std::unordered_map<Renderer, std::unique_ptr<ztextengine>>();
+	return *e;
+}
+
+ztextengine::ztextengine(Renderer renderer) : renderer(renderer), engine(TTF_CreateRendererTextEngine(renderer)) {
+	if (!engine) std::cerr << "Error: Could not create text engine! " << SDL_GetError() << std::endl;
+}
+
+ztextengine::~ztextengine() {
+	if (engine) TTF_DestroyRendererTextEngine(engine);
+}
+
+ztextengine& ztextengine::get(Renderer renderer) {
+	auto& e = engines();
+	auto it = e.find(renderer);
+	if (it != e.end()) return *it->second;
+	return *e.emplace(renderer, std::make_unique<ztextengine>(renderer)).first->second;
+}
+
+void ztextengine::drop(Renderer renderer) {
+	engines().erase(renderer);
+}
+
+Text ztextengine::create(const Font font, const char* text, Color color) {
+	if (!engine) return nullptr;
+	Text t = TTF_CreateText(engine, font, text, std::strlen(text));
+	if (!t) { std::cerr << "Error: Could not create text! " << SDL_GetError() << std::endl; return nullptr; }
+	TTF_SetTextColor(t, color.r, color.g, color.b, color.a);
+	return t;
+}
+
+TTF_TextEngine* ztextengine::getEngine() const {
+	return engine;
+}
@@ -0,0 +1,228 @@
+#include "ztextfield.h"
+#include "zbatch.h"
+#include "zprof.h"
+#include "ztextengine.h"
+#include <algorithm>
+
+ztextfield::ztextfield(Renderer renderer, Font font, Bound bound, Color box, Color text, float radiusScale)
+	: renderer(renderer), font(font), textColor(text), obj(bound, box, renderer), gapStart(0), gapEnd(0),
+	  caretX(0.0f), scrollX(0.0f), padding(15), mask(0), focused(false), textX(0.0f), shapedWidth(-1.0f), textDirty(true) {
+	this->text = ztextengine::get(renderer).create(font, "", text);
+	obj.fill(radiusScale);
+	obj.addItem();
+	obj.drawWith([this](zbatch& batch, const FBound& dst) { paint(batch, dst); });
+	obj.setActiveID(0);
+}
+
+ztextfield::~ztextfield() {
+	if (text) TTF_DestroyText(text);
+}
+
+size_t ztextfield::size() const {
+	return cells.size() - (gapEnd - gapStart);
+}
+
+const ztextfield::Cell& ztextfield::at(size_t index) const {
+	return index < gapStart ? cells[index] : cells[index + (gapEnd - gapStart)];
+}
+
+// Metrics only, the pixels are the text engine's business
+float ztextfield::advance(Uint32 cp) {
+	auto it = advances.find(cp);
+	if (it != advances.end()) return it->second;
+	int minx, maxx, miny, maxy, adv;
+	float a = TTF_GetGlyphMetrics(font, cp, &minx, &maxx, &miny, &maxy, &adv) ? static_cast<float>(adv) : 0.0f;
+	advances.emplace(cp, a);
+	return a;
+}
+
+void ztextfield::insert(Uint32 cp) {
+	if (gapStart == gapEnd) {
+		// Gap used up: double the buffer and move the text after the caret to the end
+		size_t tail = cells.size() - gapEnd;
+		size_t grown = cells.size() < 16 ? 32 : cells.size() * 2;
+		cells.resize(grown);
+		std::move_backward(cells.begin() + gapEnd, cells.begin() + gapEnd + tail, cells.end());
+		gapEnd = grown - tail;
+	}
+	float a = advance(mask ? mask : cp);
+	cells[gapStart++] = { cp, a };
+	caretX += a;
+}
+
+void ztextfield::insert(const char* utf8) {
+	if (!utf8) return;
+	size_t len = SDL_strlen(utf8);
+	while (len > 0) {
+		Uint32 cp = SDL_StepUTF8(&utf8, &len);
+		if (cp == 0) break;
+		insert(cp);
+	}
+	changed();
+}
+
+// Backspace, or Delete when forward is true
+bool ztextfield::erase(bool forward) {
+	if (forward) {
+		if (gapEnd == cells.size()) return false;
+		gapEnd++;
+	} else {
+		if (gapStart == 0) return false;
+		caretX -= cells[--gapStart].advance;
+	}
+	changed();
+	return true;
+}
+
+void ztextfield::moveCaret(int delta) {
+	for (; delta > 0 && gapEnd < cells.size(); delta--) {
+		caretX += cells[gapEnd].advance;
+		cells[gapStart++] = cells[gapEnd++];
+	}
+	for (; delta < 0 && gapStart > 0; delta++) {
+		cells[--gapEnd] = cells[--gapStart];
+		caretX -= cells[gapEnd].advance;
+	}
+	changed();
+}
+
+void ztextfield::setCaret(size_t index) {
+	index = std::min(index, size());
+	moveCaret(static_cast<int>(index) - static_cast<int>(gapStart));
+}
+
+// Caret index closest to window x; walks from the caret, so a click in view touches only visible cells
+size_t ztextfield::hitTest(int x) const {
+	const Bound b = obj.getRealBound(0);   // where show() puts it, anchor applied
+	float rel = x - (b.x + padding) + scrollX;
+	size_t k = gapStart;
+	float pos = caretX;
+	while (k > 0 && pos - at(k - 1).advance * 0.5f > rel) pos -= at(--k).advance;
+	while (k < size() && pos + at(k).advance * 0.5f < rel) pos += at(k++).advance;
+	return k;
+}
+
+void ztextfield::scrollToCaret() {
+	float inner = static_cast<float>(obj.getBounds()[0].origin.w - 2 * padding) - 2.0f;
+	if (caretX - scrollX > inner) scrollX = caretX - inner;
+	if (caretX < scrollX) scrollX = caretX;
+	if (scrollX < 0.0f) scrollX = 0.0f;
+}
+
+void ztextfield::changed() {
+	scrollToCaret();
+	textDirty = true;
+	obj.markDirty();
+}
+
+// Sets the text to the cells that fit the box whole. The caret is always in view: step back to the
+// first visible cell, then collect up to the right edge; glyphs not in the engine's atlas yet are
+// the only ones uploaded.
+void ztextfield::shape(float inner) {
+	ZPROF_SCOPE(ProfSection::TEXT);
+	textDirty = false;
+	shapedWidth = inner;
+	std::string visible;
+	char buf[4];
+	size_t k = gapStart;
+	float x = caretX;
+	textX = 0.0f;
+	while (k > 0 && x > scrollX) x -= at(--k).advance;
+	for (size_t n = size(); k < n && x < scrollX + inner; x += at(k++).advance) {
+		const Cell& c = at(k);
+		if (x < scrollX || x + c.advance > scrollX + inner) continue;
+		if (visible.empty()) textX = x;
+		char* end = SDL_UCS4ToUTF8(mask ? mask : c.cp, buf);
+		visible.append(buf, end - buf);
+	}
+	if (!TTF_SetTextString(text, visible.c_str(), visible.size())) {
+		std::cerr << "Error: Could not set text! " << SDL_GetError() << std::endl;
+	}
+}
+
+void ztextfield::paint(zbatch& batch, const FBound& dst) {
+	float lineH = static_cast<float>(TTF_GetFontHeight(font));
+	float inner = dst.w - 2 * padding;
+	float x0 = dst.x + padding - scrollX;
+	float y = dst.y + (dst.h - lineH) * 0.5f;
+
+	if (text) {
+		if (textDirty || inner != shapedWidth) shape(inner);
+		batch.flush();  // the text engine submits its own geometry, keep draw order
+		TTF_DrawRendererText(text, x0 + textX, y);
+	}
+	if (focused) batch.pushRect({ x0 + caretX, y, 2.0f, lineH }, textColor);
+}
+
+bool ztextfield::handle(const Event& e) {
+	switch (e.type) {
+		case SDL_EVENT_MOUSE_BUTTON_DOWN: {
+			if (e.button.button != SDL_BUTTON_LEFT) return false;
+			const Bound b = obj.getRealBound(0);
+			SDL_Point p = { static_cast<int>(e.button.x), static_cast<int>(e.button.y) };
+			bool inside = SDL_PointInRect(&p, &b);
+			setFocus(inside);
+			if (inside) setCaret(hitTest(p.x));
+			return inside;
+		}
+		case SDL_EVENT_TEXT_INPUT:
+			if (!focused) return false;
+			insert(e.text.text);
+			return true;
+		case SDL_EVENT_KEY_DOWN:
+			if (!focused) return false;
+			switch (e.key.key) {
+				case SDLK_BACKSPACE: erase(false); return true;
+				case SDLK_DELETE: erase(true); return true;
+				case SDLK_LEFT: moveCaret(-1); return true;
+				case SDLK_RIGHT: moveCaret(1); return true;
+				case SDLK_HOME: setCaret(0); return true;
+				case SDLK_END: setCaret(size()); return true;
+				default: return false;
+			}
+		default:
+			return false;
+	}
+}
+
+void ztextfield::setFocus(bool enable) {
+	if (focused == enable) return;
+	focused = enable;
+	obj.markDirty();
+}
+
+// Password style fields; advances follow the mask glyph
+void ztextfield::setMask(Uint32 cp) {
+	mask = cp;
+	caretX = 0.0f;
+	for (size_t i = 0; i < cells.size(); i++) {
+		if (i >= gapStart && i < gapEnd) continue;
+		cells[i].advance = advance(mask ? mask : cells[i].cp);
+		if (i < gapStart) caretX += cells[i].advance;
+	}
+	changed();
+}
+
+// Rebuilt on demand as UTF-8
+std::string ztextfield::getText() const {
+	std::string out;
+	out.reserve(size());
+	char buf[4];
+	for (size_t i = 0; i < size(); i++) {
+		char* end = SDL_UCS4ToUTF8(at(i).cp, buf);
+		out.append(buf, end - buf);
+	}
+	return out;
+}
+
+size_t ztextfield::getCaret() const {
+	return gapStart;
+}
+
+bool ztextfield::isFocused() const {
+	return focused;
+}
+
+zbj& ztextfield::getObject() {
+	return obj;
+}
@@ -0,0 +1,131 @@
+// zketch_pack.cpp
+// Bakes images and other files into one zpack archive. Images are decoded here once, with
+// SDL_image, and stored as RGBA32 rows; everything else (fonts) is stored byte for byte.
+// Entries are named by the path as given on the command line, so pass the same relative
+// paths the app uses and run the tool from the same directory.
+// Usage: zketch-pack <out.zpk> <file|directory>...
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "zpack.h"
+
+namespace fs = std::filesystem;
+
+struct Baked {
+	std::string name;
+	PackEntry entry;
+	std::vector<Uint8> bytes;
+};
+
+static bool isImage(const fs::path& p) {
+	std::string ext = p.extension().string();
+	std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+	static const char* exts[] = { ".png", ".jpg", ".jpeg", ".bmp", ".gif", ".tga", ".webp", ".qoi", ".avif", ".svg" };
+	for (const char* e : exts) {
+		if (ext == e) return true;
+	}
+	return false;
+}
+
+static bool bakeImage(const std::string& path, Baked& out) {
+	Surface loaded = IMG_Load(path.c_str());
+	if (!loaded) { std::fprintf(stderr, "Error: Could not load image %s: %s\n", path.c_str(), SDL_GetError()); return false; }
+	Surface s = SDL_ConvertSurface(loaded, SDL_PIXELFORMAT_RGBA32);
+	SDL_DestroySurface(loaded);
+	if (!s) { std::fprintf(stderr, "Error: Could not convert %s: %s\n", path.c_str(), SDL_GetError()); return false; }
+	Uint32 pitch = static_cast<Uint32>(s->w) * 4;
+	out.bytes.resize(static_cast<size_t>(pitch) * s->h);
+	for (int y = 0; y < s->h; y++) {
+		std::memcpy(out.bytes.data() + static_cast<size_t>(y) * pitch, static_cast<const Uint8*>(s->pixels) + static_cast<size_t>(y) * s->pitch, pitch);
+	}
+	out.entry.kind = static_cast<Uint32>(PackKind::IMAGE);
+	out.entry.format = SDL_PIXELFORMAT_RGBA32;
+	out.entry.w = static_cast<Uint32>(s->w);
+	out.entry.h = static_cast<Uint32>(s->h);
+	out.entry.pitch = pitch;
+	SDL_DestroySurface(s);
+	return true;
+}
+
+static bool bakeFile(const std::string& path, Baked& out) {
+	size_t size = 0;
+	void* data = SDL_LoadFile(path.c_str(), &size);
+	if (!data) { std::fprintf(stderr, "Error: Could not read %s: %s\n", path.c_str(), SDL_GetError()); return false; }
+	out.bytes.assign(static_cast<Uint8*>(data), static_cast<Uint8*>(data) + size);
+	SDL_free(data);
+	out.entry.kind = static_cast<Uint32>(PackKind::FILE);
+	return true;
+}
+
+// Directories are walked recursively and sorted, so the same input gives the same pack
+static void collect(const char* arg, std::vector<std::string>& paths) {
+	std::error_code ec;
+	if (!fs::is_directory(arg, ec)) { paths.push_back(zpack::normalize(arg)); return; }
+	std::vector<std::string> found;
+	for (const auto& e : fs::recursive_directory_iterator(arg, ec)) {
+		if (e.is_regular_file()) found.push_back(zpack::normalize(e.path().generic_string().c_str()));
+	}
+	std::sort(found.begin(), found.end());
+	paths.insert(paths.end(), found.begin(), found.end());
+}
+
+static bool write(const char* out, std::vector<Baked>& baked) {
+	std::string names;
+	for (Baked& b : baked) {
+		b.entry.nameOffset = static_cast<Uint32>(names.size());
+		b.entry.nameLength = static_cast<Uint32>(b.name.size());
+		names += b.name;
+	}
+	auto align = [](Uint64 v) { return (v + PACK_ALIGN - 1) / PACK_ALIGN * PACK_ALIGN; };
+	Uint64 offset = align(sizeof(PackHeader) + baked.size() * sizeof(PackEntry) + names.size());
+	for (Baked& b : baked) {
+		b.entry.offset = offset;
+		b.entry.size = b.bytes.size();
+		offset = align(offset + b.bytes.size());
+	}
+
+	FILE* f = std::fopen(out, "wb");
+	if (!f) { std::fprintf(stderr, "Error: Could not open %s for writing!\n", out); return false; }
+	PackHeader header = {};
+	std::memcpy(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC));
+	header.version = PACK_VERSION;
+	header.count = static_cast<Uint32>(baked.size());
+	header.namesSize = static_cast<Uint32>(names.size());
+	bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1;
+	for (const Baked& b : baked) ok &= std::fwrite(&b.entry, sizeof(PackEntry), 1, f) == 1;
+	ok &= std::fwrite(names.data(), 1, names.size(), f) == names.size();
+	static const Uint8 zeros[PACK_ALIGN] = {};
+	for (const Baked& b : baked) {
+		long pad = static_cast<long>(b.entry.offset) - std::ftell(f);
+		if (pad > 0) ok &= std::fwrite(zeros, 1, pad, f) == static_cast<size_t>(pad);
+		ok &= std::fwrite(b.bytes.data(), 1, b.bytes.size(), f) == b.bytes.size();
+	}
+	ok &= std::fclose(f) == 0;
+	if (!ok) std::fprintf(stderr, "Error: Could not write %s!\n", out);
+	return ok;
+}
+
+int main(int argc, char** argv) {
+	if (argc < 3) { std::fprintf(stderr, "Usage: %s <out.zpk> <file|directory>...\n", argv[0]); return 2; }
+	std::vector<std::string> paths;
+	for (int i = 2; i < argc; i++) collect(argv[i], paths);
+
+	std::vector<Baked> baked;
+	size_t images = 0, files = 0, bytes = 0;
+	for (const std::string& path : paths) {
+		Baked b = {};
+		b.name = path;
+		bool image = isImage(path);
+		if (!(image ? bakeImage(path, b) : bakeFile(path, b))) return 1;
+		(image ? images : files)++;
+		bytes += b.bytes.size();
+		baked.push_back(std::move(b));
+	}
+	if (!write(argv[1], baked)) return 1;
+	std::printf("%s: %zu images, %zu files, %.1f MB\n", argv[1], images, files, bytes / (1024.0 * 1024.0));
+	return 0;
+}